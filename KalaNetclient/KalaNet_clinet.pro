@@ -1,4 +1,4 @@
-QT       += core gui widgets network
+QT       += core gui widgets network concurrent
 
 CONFIG += c++17 console
 
@@ -14,7 +14,15 @@ SOURCES += \
     src/LoginDialog.cpp \
     src/MainWindow.cpp \
     src/DataManager.cpp \
-    src/NetworkManager.cpp
+    src/NetworkManager.cpp \
+    src/Money.cpp \
+    src/TextFormat.cpp \
+    src/ImageStore.cpp \
+    src/ImageCache.cpp \
+    src/ImageLoader.cpp \
+    src/ProductTableModel.cpp \
+    src/ProductFilterModel.cpp \
+    src/CatalogCache.cpp
 
 HEADERS += \
     include/Product.h \
@@ -22,7 +30,16 @@ HEADERS += \
     include/LoginDialog.h \
     include/MainWindow.h \
     include/DataManager.h \
-    include/NetworkManager.h
+    include/NetworkManager.h \
+    include/ProductRow.h \
+    include/Money.h \
+    include/TextFormat.h \
+    include/ImageStore.h \
+    include/ImageCache.h \
+    include/ImageLoader.h \
+    include/ProductTableModel.h \
+    include/ProductFilterModel.h \
+    include/CatalogCache.h
 
 INCLUDEPATH += include
 
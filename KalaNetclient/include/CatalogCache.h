@@ -0,0 +1,48 @@
+#ifndef CATALOGCACHE_H
+#define CATALOGCACHE_H
+
+#include <QMutex>
+#include <QString>
+#include <memory>
+#include "ProductRow.h"
+
+// The last approved catalog received from the server, kept in one binary
+// file so the next start can show it before the server has answered.
+// The server's catalog tag is stored with it and sent back on the next
+// GET_APPROVED_PRODUCTS; an unchanged catalog then costs one short reply.
+class CatalogCache {
+public:
+    explicit CatalogCache(const QString& path);
+
+    // False if the file is missing, from another format or truncated
+    bool load(ProductRows& rows, QString& version) const;
+    // Written on the thread pool; the file is replaced atomically. Writes
+    // run one at a time in call order, and a snapshot still waiting when a
+    // newer one arrives is skipped.
+    void save(const ProductRows& rows, const QString& version) const;
+    // Removes the file, after any write already started
+    void clear() const;
+
+    QString path() const { return m_path; }
+
+private:
+    // The newest snapshot not yet on disk, shared with the running task so
+    // it outlives the cache
+    struct Writer {
+        QMutex mutex;
+        bool running = false;
+        bool pending = false;
+        bool remove = false;  // pending snapshot is a clear()
+        ProductRows rows;
+        QString version;
+    };
+
+    void enqueue(bool remove, const ProductRows& rows, const QString& version) const;
+    static void drain(const QString& path, const std::shared_ptr<Writer>& writer);
+    static bool write(const QString& path, const ProductRows& rows, const QString& version);
+
+    QString m_path;
+    std::shared_ptr<Writer> m_writer;
+};
+
+#endif // CATALOGCACHE_H
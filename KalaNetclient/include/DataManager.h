@@ -4,11 +4,13 @@
 #include <QObject>
 #include <QVector>
 #include <QMap>
+#include <QHash>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QString>
 #include "User.h"
 #include "Product.h"
+#include "ImageStore.h"
 
 class DataManager : public QObject {
     Q_OBJECT
@@ -26,8 +28,11 @@ private:
     QString dataDir;
     QString usersFile;
     QString productsFile;
+    ImageStore* imageStore; // product images, referenced by hash from products.csv
+    QHash<int, QString> legacyImages; // base64 image fields that failed to migrate, by product id
 
     DataManager(QObject* parent = nullptr);
+    ~DataManager();
 
     // CSV helpers
     QString escapeCSV(const QString& str);
@@ -0,0 +1,34 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+// Disk cache of images fetched with GET_IMAGE, one file per blob hash and
+// size. The server's etag for an image is the SHA-256 of its bytes, so a
+// cached entry can be revalidated without storing anything beside it.
+// The least recently used files are evicted once the cache grows past its
+// byte limit; a hit refreshes the file's modification time.
+class ImageCache {
+public:
+    explicit ImageCache(const QString& directory, qint64 maxBytes = 64 * 1024 * 1024);
+
+    // Cached bytes, or an empty array on a miss
+    QByteArray get(const QString& hash, const QString& size) const;
+    void put(const QString& hash, const QString& size, const QByteArray& data);
+
+    qint64 totalBytes() const { return m_totalBytes; }
+    QString directory() const { return m_directory; }
+
+    static QString etagOf(const QByteArray& data);
+
+private:
+    QString pathFor(const QString& hash, const QString& size) const;
+    void evict();
+
+    QString m_directory;
+    qint64 m_maxBytes;
+    qint64 m_totalBytes;
+};
+
+#endif // IMAGECACHE_H
@@ -0,0 +1,57 @@
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+#include <QObject>
+#include <QCache>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QString>
+#include <functional>
+
+class QFutureWatcherBase;
+template <typename T> class QFuture;
+
+// Decodes, scales and encodes product images on the global thread pool
+// so large photos never stall the GUI thread. Decoded pixmaps are kept in
+// an LRU keyed by product id, image hash and size. Every request names a
+// context object; when it is destroyed (e.g. its dialog closes) the work
+// is cancelled and the callback is dropped. Use from the GUI thread only.
+class ImageLoader : public QObject {
+    Q_OBJECT
+public:
+    using PixmapCallback = std::function<void(const QPixmap&)>;
+    using HashCallback = std::function<void(const QString&)>;
+
+    explicit ImageLoader(QObject* parent = nullptr);
+    ~ImageLoader();
+
+    // Calls 'done' with the image scaled to fit 'size', or a null pixmap
+    // if it can't be loaded. Cache hits are delivered before this returns.
+    void loadPixmap(int productId, const QString& imageHash, const QSize& size,
+                    QObject* context, PixmapCallback done);
+    // Same, for encoded bytes already in hand (e.g. from GET_IMAGE)
+    void decodePixmap(const QString& imageHash, const QByteArray& data, const QSize& size,
+                      QObject* context, PixmapCallback done);
+
+    // Reads an image file, scales it to fit 'maxSize' and puts it in the
+    // image store; 'done' gets the hash, or an empty string on failure
+    void storeFile(const QString& fileName, const QSize& maxSize,
+                   QObject* context, HashCallback done);
+
+    void cancelAll();
+    int pendingCount() const { return m_pending.size(); }
+
+    // Limit on cached pixmap memory, in kilobytes
+    void setCacheCapacity(int kilobytes);
+
+private:
+    static QString cacheKey(int productId, const QString& imageHash, const QSize& size);
+    void deliver(QFuture<QImage> future, const QString& key, QObject* context, PixmapCallback done);
+    void track(QFutureWatcherBase* watcher, QObject* context);
+
+    QCache<QString, QPixmap> m_cache;
+    QSet<QFutureWatcherBase*> m_pending;
+};
+
+#endif // IMAGELOADER_H
@@ -0,0 +1,36 @@
+#ifndef IMAGESTORE_H
+#define IMAGESTORE_H
+
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+
+// Content-addressed image blobs. Each blob is a file named by the SHA-256
+// of its bytes under <directory>/<first two hex digits>/, so storing the
+// same image twice writes it once and records only need to keep the hash.
+class ImageStore {
+public:
+    explicit ImageStore(const QString& directory);
+
+    // Stores 'data' unless a blob with the same hash exists; returns the
+    // hash, or an empty string if the blob could not be written
+    QString put(const QByteArray& data);
+    // Blob bytes, or an empty array for an unknown hash
+    QByteArray get(const QString& hash) const;
+    bool contains(const QString& hash) const;
+
+    // Deletes every blob whose hash is not in 'referenced'; returns the count
+    int prune(const QSet<QString>& referenced);
+
+    QString directory() const { return m_directory; }
+    QString pathFor(const QString& hash) const;
+
+    static QString hashOf(const QByteArray& data);
+    // True for a 64-digit lowercase hex string
+    static bool isValidHash(const QString& hash);
+
+private:
+    QString m_directory;
+};
+
+#endif // IMAGESTORE_H
@@ -4,6 +4,7 @@
 #include <QMainWindow>
 #include <QTabWidget>
 #include <QTableWidget>
+#include <QTableView>
 #include <QPushButton>
 #include <QLabel>
 #include <QLineEdit>
@@ -12,7 +13,15 @@
 #include <QComboBox>
 #include <QTextEdit>
 #include <QGroupBox>
+#include <QMap>
 #include "User.h"
+#include "ProductRow.h"
+
+class ImageLoader;
+class CatalogCache;
+class ProductTableModel;
+class ProductFilterModel;
+class QAbstractItemModel;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -40,18 +49,25 @@ private slots:
     void onAddToCart();
     void onViewProductDetails();
     void refreshProductList();
+    void onCatalogReceived(const ProductRows& products, const QString& version);
+    void onImageReceived(const QString& hash, const QString& size, const QByteArray& data);
 
     // Cart tab
     void onRemoveFromCart();
     void onClearCart();
     void onCheckout();
     void refreshCart();
+    void onCartReceived(const QMap<int, int>& cart, Money total);
+    void onCheckoutResult(bool success, Money total, const QString& error);
 
     // Wallet tab
     void onDepositFunds();
     void onWithdrawFunds();
     void refreshWallet();
     void refreshTransactionHistory();
+    void onLoadMoreHistory();
+    void onHistoryReceived(const QVector<Transaction>& rows, int nextCursor);
+    void onWalletReceived(Money balance);
 
     // Admin tab
     void onAddProduct();
@@ -80,9 +96,21 @@ private:
     void updateProfileInfo();
     void showError(const QString& message);
     void showSuccess(const QString& message);
+    QTableView* createProductView(QAbstractItemModel* model);
+    // Product id of the view's current row, or -1 with no selection
+    int selectedProductId(QTableView* view) const;
+    // Catalog row of a product shown in the Products tab, or nullptr
+    const ProductRow* catalogRow(int productId) const;
+    void showCart(const QMap<int, int>& cart, Money total);
 
     User* currentUser;
     bool isAdmin;
+    ImageLoader* imageLoader; // background decode/scale of product images
+    CatalogCache* catalogCache; // last server catalog, shown at startup
+    QString catalogVersion;     // its tag, sent back to skip unchanged catalogs
+    // The cart as the server last reported it, while connected
+    QMap<int, int> serverCart;
+    Money serverCartTotal;
 
     // Main widget
     QTabWidget* tabWidget;
@@ -110,14 +138,16 @@ private:
     QLineEdit* searchEdit;
     QComboBox* categoryCombo;
     QPushButton* searchButton;
-    QTableWidget* productsTable;
+    QTableView* productsTable;
+    ProductTableModel* productsModel;
+    ProductFilterModel* productsFilter; // search and category over productsModel
     QPushButton* addToCartButton;
     QPushButton* viewDetailsButton;
     QLabel* productDetailsLabel;
     QLabel* productImageLabel;      // For showing product image in dialogs
     QPushButton* uploadImageButton; // For uploading image
     QPushButton* clearImageButton;  // For clearing image
-    QString currentImageBase64;
+    QString currentImageHash;       // Image store hash of the dialog's image
 
     // Cart tab
     QWidget* cartTab;
@@ -133,6 +163,10 @@ private:
     QDoubleSpinBox* depositSpinBox;
     QPushButton* depositButton;
     QTableWidget* transactionTable;
+    QComboBox* historyRoleCombo;
+    QPushButton* loadMoreHistoryButton;
+    int historyCursor;        // cursor of the next page, 0 when none
+    bool historyAppend;       // the pending page extends the table
 
     // Admin tab
     QWidget* adminTab;
@@ -140,7 +174,8 @@ private:
 
     // Admin - All Products
     QWidget* adminProductsTab;
-    QTableWidget* adminProductsTable;
+    QTableView* adminProductsTable;
+    ProductTableModel* adminProductsModel;
     QPushButton* addProductButton;
     QPushButton* registerProductButton;
     QPushButton* editProductButton;
@@ -148,13 +183,15 @@ private:
 
     // Admin - Pending Approvals
     QWidget* pendingTab;
-    QTableWidget* pendingTable;
+    QTableView* pendingTable;
+    ProductTableModel* pendingModel;
     QPushButton* approveButton;
     QPushButton* rejectButton;
 
     // My Products tab (for customers)
     QWidget* myProductsTab;
-    QTableWidget* myProductsTable;
+    QTableView* myProductsTable;
+    ProductTableModel* myProductsModel;
     QPushButton* registerNewProductButton;
     QLabel* myProductsInfoLabel;
 };
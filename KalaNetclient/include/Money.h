@@ -0,0 +1,59 @@
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QByteArrayView>
+#include <QDataStream>
+
+// Amount of money as an integer count of cents.
+// Sums and products are exact; text is always "<units>.<cc>".
+class Money {
+public:
+    static constexpr qint64 Scale = 100; // minor units per unit
+
+    constexpr Money() : m_cents(0) {}
+
+    static constexpr Money fromCents(qint64 cents) { return Money(cents); }
+    static constexpr Money fromUnits(qint64 units) { return Money(units * Scale); }
+    // Rounds to the nearest cent; for values coming from spin boxes.
+    // Zero when the value does not fit.
+    static Money fromDouble(double value);
+    // Parses "12", "12.3", "-12.34"; older files may also hold "1e+06".
+    // Returns zero and sets *ok to false on malformed or out-of-range input.
+    static Money fromString(QStringView text, bool* ok = nullptr);
+    // Same on UTF-8 bytes that are already trimmed
+    static Money fromUtf8(QByteArrayView text, bool* ok = nullptr);
+
+    constexpr qint64 cents() const { return m_cents; }
+    double toDouble() const { return double(m_cents) / Scale; }
+    QString toString() const;
+
+    constexpr bool isZero() const { return m_cents == 0; }
+    constexpr bool isNegative() const { return m_cents < 0; }
+
+    constexpr Money operator-() const { return Money(-m_cents); }
+    constexpr Money operator+(Money other) const { return Money(m_cents + other.m_cents); }
+    constexpr Money operator-(Money other) const { return Money(m_cents - other.m_cents); }
+    constexpr Money operator*(qint64 quantity) const { return Money(m_cents * quantity); }
+    Money& operator+=(Money other) { m_cents += other.m_cents; return *this; }
+    Money& operator-=(Money other) { m_cents -= other.m_cents; return *this; }
+
+    constexpr bool operator==(Money other) const { return m_cents == other.m_cents; }
+    constexpr bool operator!=(Money other) const { return m_cents != other.m_cents; }
+    constexpr bool operator<(Money other) const { return m_cents < other.m_cents; }
+    constexpr bool operator<=(Money other) const { return m_cents <= other.m_cents; }
+    constexpr bool operator>(Money other) const { return m_cents > other.m_cents; }
+    constexpr bool operator>=(Money other) const { return m_cents >= other.m_cents; }
+
+private:
+    constexpr explicit Money(qint64 cents) : m_cents(cents) {}
+
+    qint64 m_cents;
+};
+
+// Binary form is the raw cent count
+QDataStream& operator<<(QDataStream& stream, Money money);
+QDataStream& operator>>(QDataStream& stream, Money& money);
+
+#endif // MONEY_H
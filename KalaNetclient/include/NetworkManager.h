@@ -2,22 +2,58 @@
 #define NETWORKMANAGER_H
 
 #include <QObject>
+#include <QQueue>
+#include <QTimer>
 #include <QTcpSocket>
 #include <QMap>
 #include <QVector>
+#include <atomic>
+#include <QSet>
+#include <QDate>
+#include <QByteArrayView>
 #include "User.h"
 #include "Product.h"
-
+#include "ProductRow.h"
+#include "ImageCache.h"
+
+// Client side of the line protocol. Connecting is asynchronous; once
+// connectToServer() has been called a lost connection is retried with
+// exponential backoff, the last login is replayed to resume the session,
+// and requests that are safe to repeat (reads, uploads, idempotent
+// updates) are re-sent. Other requests cut off by the drop fail with
+// error(). Requests are answered in order, so the oldest unanswered one
+// is always the head of the in-flight queue.
+//
+// The socket, the response parsing and the image disk cache live on a
+// thread of their own. Request methods may be called from the GUI thread;
+// they are forwarded to the network thread, and every signal reaches GUI
+// receivers queued with plain value results (ProductRows and friends are
+// implicitly shared, so nothing is copied on the way).
 class NetworkManager : public QObject {
     Q_OBJECT
     Q_DISABLE_COPY(NetworkManager)
 
 public:
+    enum class HistoryRole { Any, Buyer, Seller };
+
+    // One step of cartBatch(); Set with quantity 0 removes the item
+    struct CartOp {
+        enum Kind { Add, Set, Remove } kind;
+        int productId;
+        int quantity;
+    };
+
     static NetworkManager* instance();
+    // Stops the network thread; call from the thread that created the instance
     static void destroy();
+    // Before the first instance(): false keeps socket I/O on the caller's thread
+    static void setThreaded(bool threaded);
 
-    bool connectToServer(const QString& host, quint16 port);
+    // Returns at once; connected() or reconnecting() follow
+    void connectToServer(const QString& host, quint16 port);
+    // Closes the connection and stops reconnecting
     void disconnectFromServer();
+    bool isConnected() const;
 
     // Authentication
     void login(const QString& username, const QString& password);
@@ -25,15 +61,16 @@ public:
                 const QString& email, const QString& phone,
                 const QString& address, UserType type);
 
-    // Product browsing
-    void getApprovedProducts();
+    // Product browsing. With the catalog tag of a cached copy, an unchanged
+    // catalog is answered with approvedProductsNotModified() instead of rows.
+    void getApprovedProducts(const QString& knownVersion = QString());
     void getPendingProducts();
     void getProductDetails(int productId);
 
     // Product management
     void addProduct(const QString& name, const QString& description,
-                    const QString& category, double price, int stock,
-                    const QString& seller);
+                    const QString& category, Money price, int stock,
+                    const QString& seller, const QString& imageHash = QString());
     void approveProduct(int productId);
     void rejectProduct(int productId);
 
@@ -42,6 +79,8 @@ public:
     void getCart(const QString& username);
     void removeFromCart(const QString& username, int productId);
     void clearCart(const QString& username);
+    // Applies all operations or none, answered with cartReceived()
+    void cartBatch(const QString& username, const QVector<CartOp>& ops);
     void checkout(const QString& username);
 
     // User products
@@ -49,7 +88,18 @@ public:
 
     // Wallet operations
     void getWallet(const QString& username);
-    void deposit(const QString& username, double amount);
+    void deposit(const QString& username, Money amount);
+    // One page of transactions, newest first. Pass the nextCursor of the
+    // previous page to continue; invalid dates leave the range open.
+    void getHistory(const QString& username, HistoryRole role = HistoryRole::Any,
+                    const QDate& from = QDate(), const QDate& to = QDate(),
+                    int cursor = -1, int limit = 50);
+
+    // Images. Sizes are "thumb", "medium" and "full". getImage() answers
+    // from the disk cache when it can and revalidates each entry once per
+    // session; uploadImage() sends the encoded bytes for use in addProduct().
+    void getImage(const QString& hash, const QString& size);
+    void uploadImage(const QByteArray& data);
 
     // Profile update
     void updateProfile(const QString& username, const QString& email,
@@ -58,23 +108,32 @@ public:
 signals:
     void connected();
     void disconnected();
+    // The next attempt starts after 'delayMs'
+    void reconnecting(int attempt, int delayMs);
+    // The login from before the drop was accepted again
+    void sessionResumed();
     void error(const QString& message);
 
     // Response signals
     void loginResult(bool success, User* user, const QString& error);
     void signupResult(bool success, const QString& error);
-    void approvedProductsReceived(const QVector<Product*>& products);
-    void pendingProductsReceived(const QVector<Product*>& products);
+    void approvedProductsReceived(const ProductRows& products, const QString& version);
+    void approvedProductsNotModified(const QString& version);
+    void pendingProductsReceived(const ProductRows& products);
     void productDetailsReceived(Product* product);
     void addProductResult(bool success, const QString& error);
     void approveResult(bool success, const QString& error);
     void rejectResult(bool success, const QString& error);
-    void cartReceived(const QMap<int, int>& cart, double total);
-    void checkoutResult(bool success, double total, const QString& error);
-    void myProductsReceived(const QVector<Product*>& products);
-    void walletReceived(double balance);
-    void depositResult(bool success, double newBalance, const QString& error);
+    void cartReceived(const QMap<int, int>& cart, Money total);
+    void checkoutResult(bool success, Money total, const QString& error);
+    void myProductsReceived(const ProductRows& products);
+    void walletReceived(Money balance);
+    void depositResult(bool success, Money newBalance, const QString& error);
+    // nextCursor is 0 when this was the last page
+    void historyReceived(const QVector<Transaction>& rows, int nextCursor);
     void profileUpdateResult(bool success, const QString& error);
+    void imageReceived(const QString& hash, const QString& size, const QByteArray& data);
+    void imageUploaded(const QString& hash);
 
 private slots:
     void onConnected();
@@ -86,9 +145,66 @@ private:
     explicit NetworkManager(QObject* parent = nullptr);
     ~NetworkManager();
 
+    // Product lists arrive as "OK <KIND> <count>" followed by one row per line
+    // and transaction history as "OK HISTORY <count> <nextCursor>"; carts
+    // list their items and end with a TOTAL row
+    enum class ListKind { None, Approved, Pending, Mine, History, Cart };
+
+    // Whether a request may be sent again after a dropped connection
+    enum class Retry { Replay, Drop };
+    struct PendingRequest {
+        QByteArray data;
+        Retry retry;
+        bool resume; // the automatic re-login after a reconnect
+    };
+
+    bool onNetworkThread() const;
+    void send(const QByteArray& request, Retry retry);
+    void completeRequest();
+    bool resuming() const;
+    void resetResponseState();
+    void scheduleReconnect();
+    void reconnect();
+
+    void handleLine(const QString& line);
+    void beginList(ListKind kind, const QString& header);
+    void appendRow(QByteArrayView line);
+    void finishList();
+    void finishImage(const QByteArray& data);
+
     static NetworkManager* m_instance;
+    static bool m_threaded;
     QTcpSocket* m_socket;
-    QString m_buffer;
+    QByteArray m_buffer;
+
+    ListKind m_listKind;
+    int m_listExpected; // -1 when the header carried no count
+    ProductRows m_rows;
+    QVector<Transaction> m_history;
+    int m_historyCursor;
+    QMap<int, int> m_cart;
+    Money m_cartTotal;
+    QString m_catalogVersion; // tag from the APPROVED_PRODUCTS header
+
+    // GET_IMAGE replies carry a raw payload after their header line
+    ImageCache* m_imageCache;
+    qint64 m_imageExpected; // payload bytes still to come, or 0
+    QString m_imageHash;
+    QString m_imageSize;
+    QSet<QString> m_validatedImages; // "<hash>.<size>" checked this session
+
+    // Requests written and not yet answered, or waiting for a reconnect
+    QQueue<PendingRequest> m_inFlight;
+    QString m_host;
+    quint16 m_port;
+    bool m_autoReconnect;
+    int m_reconnectAttempt;
+    QTimer m_reconnectTimer;
+    QString m_loginUser;       // last LOGIN sent
+    QString m_loginPassword;
+    QString m_sessionUser;     // last LOGIN accepted, replayed on reconnect
+    QString m_sessionPassword;
+    std::atomic<bool> m_connected; // readable from any thread
 };
 
 #endif 
\ No newline at end of file
@@ -4,8 +4,11 @@
 #include <QString>
 #include <QDateTime>
 #include <QDataStream>
+#include "Money.h"
 #include <QImage>
 
+class ImageStore;
+
 enum class ProductStatus {
     PENDING_APPROVAL,
     APPROVED,
@@ -18,18 +21,20 @@ private:
     QString name;
     QString description;
     QString category;
-    double price;
+    Money price;
     int stock;
     QString sellerUsername;
     ProductStatus status;
     QDateTime registrationDate;
     QString imagePath;
-    QString imageBase64;  // Store image as base64 string
+    QString imageHash;    // Blob in the image store; the bytes load on demand
+
+    static ImageStore* imageStore;
 
 public:
     Product();
     Product(int id, const QString& name, const QString& description,
-            const QString& category, double price, int stock,
+            const QString& category, Money price, int stock,
             const QString& seller);
 
     // Getters
@@ -37,43 +42,51 @@ public:
     QString getName() const { return name; }
     QString getDescription() const { return description; }
     QString getCategory() const { return category; }
-    double getPrice() const { return price; }
+    Money getPrice() const { return price; }
     int getStock() const { return stock; }
     QString getSellerUsername() const { return sellerUsername; }
     ProductStatus getStatus() const { return status; }
     QDateTime getRegistrationDate() const { return registrationDate; }
     QString getImagePath() const { return imagePath; }
-    QString getImageBase64() const { return imageBase64; }
+    QString getImageHash() const { return imageHash; }
 
     // Setters
     void setProductId(int id) { productId = id; }
     void setName(const QString& newName) { name = newName; }
     void setDescription(const QString& desc) { description = desc; }
     void setCategory(const QString& cat) { category = cat; }
-    void setPrice(double newPrice) { price = newPrice; }
+    void setPrice(Money newPrice) { price = newPrice; }
     void setStock(int newStock) { stock = newStock; }
     void setSellerUsername(const QString& seller) { sellerUsername = seller; }
     void setStatus(ProductStatus newStatus) { status = newStatus; }
     void setRegistrationDate(const QDateTime& date) { registrationDate = date; }
     void setImagePath(const QString& path) { imagePath = path; }
-    void setImageBase64(const QString& base64) { imageBase64 = base64; }
+    void setImageHash(const QString& hash) { imageHash = hash; }
 
     // Status helpers
     bool isApproved() const { return status == ProductStatus::APPROVED; }
     bool isPending() const { return status == ProductStatus::PENDING_APPROVAL; }
     bool isSold() const { return status == ProductStatus::SOLD; }
-    bool hasImage() const { return !imageBase64.isEmpty(); }
+    bool hasImage() const { return !imageHash.isEmpty(); }
 
-    QString getStatusString() const;
+    QString getStatusString() const { return statusString(status); }
+    static QString statusString(ProductStatus status);
 
     // Image handling
     QImage getImage() const;
     void setImage(const QImage& image);
-    void clearImage() { imageBase64.clear(); }
+    void clearImage() { imageHash.clear(); }
+
+    // Where image blobs live; set by DataManager
+    static void setImageStore(ImageStore* store) { imageStore = store; }
 
-    // Static helper for image processing
-    static QString imageToBase64(const QImage& image, int maxWidth = 400, int maxHeight = 400);
-    static QImage base64ToImage(const QString& base64);
+    // Static helpers for image processing
+    static QByteArray encodeImage(const QImage& image, int maxWidth = 400, int maxHeight = 400);
+    // Encodes 'image' into the image store and returns its hash
+    static QString storeImage(const QImage& image, int maxWidth = 400, int maxHeight = 400);
+    static QImage loadImage(const QString& hash);
+    // Encoded blob bytes, e.g. for PUT_IMAGE; empty for an unknown hash
+    static QByteArray loadImageData(const QString& hash);
     static QImage resizeImage(const QImage& source, int maxWidth, int maxHeight);
 
     // Serialization
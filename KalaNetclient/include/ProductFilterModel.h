@@ -0,0 +1,75 @@
+#ifndef PRODUCTFILTERMODEL_H
+#define PRODUCTFILTERMODEL_H
+
+#include <QFutureWatcher>
+#include <QSet>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+class ProductTableModel;
+
+// Search-as-you-type filter and sort over a ProductTableModel.
+// Matching runs on the thread pool after a short pause in typing, over an
+// implicitly shared snapshot of the source rows; the proxy then only looks
+// up the matched ids. When a query extends the previous one (same category,
+// search text grown at the end) only the previous matches are rescanned.
+// A newer query cancels the running one and stale results are dropped.
+// Use from the GUI thread only.
+class ProductFilterModel : public QSortFilterProxyModel {
+    Q_OBJECT
+public:
+    explicit ProductFilterModel(ProductTableModel* source, QObject* parent = nullptr);
+    ~ProductFilterModel();
+
+    // Case-insensitive match on name, description and category
+    void setSearchText(const QString& text);
+    // Empty for all categories
+    void setCategory(const QString& category);
+    // Runs a pending query now instead of waiting for the debounce
+    void applyNow();
+
+    void setDebounceInterval(int msecs) { m_debounce.setInterval(msecs); }
+    bool isFiltering() const { return m_watcher.isRunning(); }
+
+signals:
+    void filterApplied(int matches);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    struct Result {
+        QVector<int> rows; // matching source rows, ascending
+        QSet<int> ids;
+    };
+
+    void sourceChanged();
+    void start();
+    void finished();
+
+    ProductTableModel* m_source;
+    QTimer m_debounce;
+    QFutureWatcher<Result> m_watcher;
+    int m_serial;             // bumped per query; older results are dropped
+    int m_generation;         // bumped whenever the source rows change
+
+    QString m_text;
+    QString m_category;
+
+    // Last applied query, reused when the next one narrows it
+    bool m_active;
+    QString m_appliedText;
+    QString m_appliedCategory;
+    int m_appliedGeneration;
+    Result m_applied;
+
+    // The query the running task computes
+    QString m_runningText;
+    QString m_runningCategory;
+    int m_runningGeneration;
+    int m_runningSerial;
+};
+
+#endif // PRODUCTFILTERMODEL_H
@@ -0,0 +1,36 @@
+#ifndef PRODUCTROW_H
+#define PRODUCTROW_H
+
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include <QMetaType>
+#include "Product.h"
+#include "Money.h"
+
+// One row of a product list as sent by the server.
+// Plain value type: lists of rows live in one contiguous, implicitly
+// shared QVector, so passing them through signals copies nothing.
+struct ProductRow {
+    int productId = 0;
+    QString name;
+    QString category;
+    Money price;
+    int stock = 0;
+    QString sellerUsername;
+    ProductStatus status = ProductStatus::PENDING_APPROVAL;
+    QString imageHash; // empty when the product has no image
+    // Not on the wire; filled from the local catalog
+    QString description;
+    QDateTime registrationDate;
+
+    bool isApproved() const { return status == ProductStatus::APPROVED; }
+    bool isPending() const { return status == ProductStatus::PENDING_APPROVAL; }
+};
+
+using ProductRows = QVector<ProductRow>;
+
+Q_DECLARE_METATYPE(ProductRow)
+Q_DECLARE_METATYPE(ProductRows)
+
+#endif // PRODUCTROW_H
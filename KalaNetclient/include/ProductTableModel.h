@@ -0,0 +1,80 @@
+#ifndef PRODUCTTABLEMODEL_H
+#define PRODUCTTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QPixmap>
+#include <QSet>
+#include <QVector>
+#include "ProductRow.h"
+
+class Product;
+
+// Table model over a snapshot of product rows, shared by the products,
+// admin, pending and my-products views. Each view picks its columns.
+// The view only asks for the rows it paints, so nothing is allocated per
+// cell. setProducts() diffs the new snapshot against the current one by
+// product id and signals only the rows that were inserted, removed or
+// changed, so selection and scroll position survive a refresh.
+class ProductTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        IdColumn,
+        NameColumn,
+        CategoryColumn,
+        PriceColumn,
+        StockColumn,
+        StatusColumn,
+        SellerColumn,
+        DateColumn
+    };
+
+    // Raw values (ids, cents, dates) for sorting instead of display text
+    static constexpr int SortRole = Qt::UserRole;
+
+    explicit ProductTableModel(const QVector<Column>& columns, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+
+    void setProducts(const ProductRows& rows);
+    void setProducts(const QVector<Product*>& products);
+    void clear();
+
+    const ProductRows& products() const { return m_rows; }
+    // -1 when 'row' is out of range
+    int productIdAt(int row) const;
+    const ProductRow* rowAt(int row) const;
+
+    static ProductRow rowFor(const Product* product);
+
+    // Image thumbnails beside the name. The first time a row whose image
+    // has no thumbnail yet is painted, thumbnailNeeded() asks for it once;
+    // setThumbnail() then repaints the name column.
+    void setShowThumbnails(bool show);
+    void setThumbnail(const QString& imageHash, const QPixmap& pixmap);
+
+signals:
+    void thumbnailNeeded(const QString& imageHash);
+
+private:
+    QVariant display(const ProductRow& row, Column column) const;
+    QVariant sortKey(const ProductRow& row, Column column) const;
+    void removeMissing(const ProductRows& rows);
+
+    QVariant thumbnail(const ProductRow& row) const;
+
+    QVector<Column> m_columns;
+    ProductRows m_rows;
+
+    bool m_showThumbnails;
+    QCache<QString, QPixmap> m_thumbnails;  // by image hash
+    mutable QSet<QString> m_thumbnailsWanted; // requested, not yet arrived
+};
+
+#endif // PRODUCTTABLEMODEL_H
@@ -6,6 +6,7 @@
 #include <QDataStream>
 #include <QVector>
 #include <QMap>
+#include "Money.h"
 
 // Forward declarations
 class Product;
@@ -22,7 +23,7 @@ struct Transaction {
     QString sellerUsername;
     QString buyerUsername;
     int quantity;
-    double totalPrice;
+    Money totalPrice;
     QDateTime date;
 
     void saveToStream(QDataStream& stream) const;
@@ -36,7 +37,7 @@ protected:
     QString email;
     QString phone;
     QString address;
-    double walletBalance;
+    Money walletBalance;
     UserType userType;
 
 public:
@@ -51,7 +52,7 @@ public:
     QString getEmail() const { return email; }
     QString getPhone() const { return phone; }
     QString getAddress() const { return address; }
-    double getWalletBalance() const { return walletBalance; }
+    Money getWalletBalance() const { return walletBalance; }
     UserType getType() const { return userType; }
 
     // Setters
@@ -60,11 +61,11 @@ public:
     void setEmail(const QString& mail) { email = mail; }
     void setPhone(const QString& ph) { phone = ph; }
     void setAddress(const QString& addr) { address = addr; }
-    void setWalletBalance(double balance) { walletBalance = balance; }
+    void setWalletBalance(Money balance) { walletBalance = balance; }
 
     // Wallet operations
-    void addFunds(double amount) { walletBalance += amount; }
-    bool deductFunds(double amount);
+    void addFunds(Money amount) { walletBalance += amount; }
+    bool deductFunds(Money amount);
 
     // Virtual methods
     virtual UserType getUserType() const = 0;
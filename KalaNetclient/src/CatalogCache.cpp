@@ -0,0 +1,118 @@
+#include "CatalogCache.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+namespace {
+const quint32 kMagic = 0x4b4e4343; // "KNCC"
+const quint32 kFormat = 1;
+}
+
+CatalogCache::CatalogCache(const QString& path)
+    : m_path(path), m_writer(std::make_shared<Writer>()) {
+}
+
+bool CatalogCache::load(ProductRows& rows, QString& version) const {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint32 format = 0;
+    qint32 count = 0;
+    in >> magic >> format;
+    if (magic != kMagic || format != kFormat)
+        return false;
+    in >> version >> count;
+    if (in.status() != QDataStream::Ok || count < 0)
+        return false;
+
+    ProductRows loaded;
+    loaded.reserve(qMin(count, 1 << 20));
+    for (qint32 i = 0; i < count; ++i) {
+        ProductRow row;
+        qint32 status = 0;
+        in >> row.productId >> row.name >> row.category >> row.price >> row.stock
+           >> row.sellerUsername >> status >> row.imageHash;
+        if (in.status() != QDataStream::Ok) {
+            qDebug() << "Catalog cache is truncated:" << m_path;
+            version.clear();
+            return false;
+        }
+        row.status = ProductStatus(status);
+        loaded.append(row);
+    }
+    rows = loaded;
+    return true;
+}
+
+void CatalogCache::save(const ProductRows& rows, const QString& version) const {
+    enqueue(false, rows, version);
+}
+
+void CatalogCache::enqueue(bool remove, const ProductRows& rows, const QString& version) const {
+    QMutexLocker locker(&m_writer->mutex);
+    // The rows are implicitly shared, so keeping a copy is free
+    m_writer->pending = true;
+    m_writer->remove = remove;
+    m_writer->rows = rows;
+    m_writer->version = version;
+    if (m_writer->running)
+        return; // the running task picks it up next
+    m_writer->running = true;
+
+    QString path = m_path;
+    std::shared_ptr<Writer> writer = m_writer;
+    (void)QtConcurrent::run([path, writer]() { drain(path, writer); });
+}
+
+void CatalogCache::drain(const QString& path, const std::shared_ptr<Writer>& writer) {
+    for (;;) {
+        bool remove;
+        ProductRows rows;
+        QString version;
+        {
+            QMutexLocker locker(&writer->mutex);
+            if (!writer->pending) {
+                writer->running = false;
+                return;
+            }
+            writer->pending = false;
+            remove = writer->remove;
+            rows = std::move(writer->rows);
+            version = std::move(writer->version);
+        }
+        if (remove)
+            QFile::remove(path);
+        else
+            write(path, rows, version);
+    }
+}
+
+bool CatalogCache::write(const QString& path, const ProductRows& rows, const QString& version) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to write catalog cache:" << path;
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << kMagic << kFormat << version << qint32(rows.size());
+    for (const ProductRow& row : rows) {
+        out << row.productId << row.name << row.category << row.price << row.stock
+            << row.sellerUsername << qint32(row.status) << row.imageHash;
+    }
+    return out.status() == QDataStream::Ok && file.commit();
+}
+
+void CatalogCache::clear() const {
+    enqueue(true, ProductRows(), QString());
+}
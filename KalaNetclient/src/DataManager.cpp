@@ -21,9 +21,17 @@ DataManager::DataManager(QObject* parent)
         }
     }
 
+    imageStore = new ImageStore(dataDir + "/images");
+    Product::setImageStore(imageStore);
+
     loadAllData();
 }
 
+DataManager::~DataManager() {
+    Product::setImageStore(nullptr);
+    delete imageStore;
+}
+
 DataManager* DataManager::getInstance() {
     QMutexLocker locker(&instanceMutex);
     if (instance == nullptr) {
@@ -126,6 +134,7 @@ bool DataManager::removeProduct(int productId) {
     }
     Product* product = products[productId];
     products.remove(productId);
+    legacyImages.remove(productId);
     delete product;
     saveProductsToCSV();
     emit dataChanged();
@@ -232,6 +241,7 @@ bool DataManager::rejectProduct(int productId) {
     }
     // Remove from map before deleting
     products.remove(productId);
+    legacyImages.remove(productId);
     delete product;
     saveProductsToCSV();
     emit productRejected(productId);
@@ -290,7 +300,7 @@ bool DataManager::saveUsersToCSV() {
                << escapeCSV(user->getEmail()) << ","
                << escapeCSV(user->getPhone()) << ","
                << escapeCSV(user->getAddress()) << ","
-               << user->getWalletBalance() << ","
+               << user->getWalletBalance().toString() << ","
                << (user->getUserType() == UserType::ADMIN ? "admin" : "customer") << ","
                << escapeCSV(registeredProductsStr)
                << "\n";
@@ -304,7 +314,7 @@ bool DataManager::loadUsersFromCSV() {
     if (!file.exists()) {
         Admin* admin = new Admin("admin", User::hashPassword("Admin123"),
                                  "admin@kalanet.com", "09123456789", "IUT");
-        admin->addFunds(10000);
+        admin->addFunds(Money::fromUnits(10000));
         users["admin"] = admin;
         return saveUsersToCSV();
     }
@@ -336,7 +346,7 @@ bool DataManager::loadUsersFromCSV() {
             QString email = unescapeCSV(parts[2]);
             QString phone = unescapeCSV(parts[3]);
             QString address = unescapeCSV(parts[4]);
-            double wallet = parts[5].toDouble();
+            Money wallet = Money::fromString(parts[5]);
             QString type = parts[6];
 
             User* user = nullptr;
@@ -373,7 +383,7 @@ bool DataManager::loadUsersFromCSV() {
     if (users.isEmpty()) {
         Admin* admin = new Admin("admin", User::hashPassword("Admin123"),
                                  "admin@kalanet.com", "09123456789", "IUT");
-        admin->addFunds(10000);
+        admin->addFunds(Money::fromUnits(10000));
         users["admin"] = admin;
         saveUsersToCSV();
     }
@@ -422,8 +432,8 @@ bool DataManager::saveProductsToCSV() {
 
     QTextStream stream(&file);
     stream.setEncoding(QStringConverter::Utf8);
-    // Updated header to include image_base64
-    stream << "product_id,name,description,category,price,stock,seller,status,next_id,image_base64\n";
+    // Images live in the image store; rows only carry the hash
+    stream << "product_id,name,description,category,price,stock,seller,status,next_id,image_hash\n";
 
     for (auto it = products.begin(); it != products.end(); ++it) {
         Product* p = it.value();
@@ -437,12 +447,13 @@ bool DataManager::saveProductsToCSV() {
                << escapeCSV(p->getName()) << ","
                << escapeCSV(p->getDescription()) << ","
                << escapeCSV(p->getCategory()) << ","
-               << p->getPrice() << ","
+               << p->getPrice().toString() << ","
                << p->getStock() << ","
                << escapeCSV(p->getSellerUsername()) << ","
                << statusStr << ","
                << nextProductId << ","
-               << escapeCSV(p->getImageBase64())  // Save image as base64
+               << (p->getImageHash().isEmpty() ? legacyImages.value(p->getProductId())
+                                               : p->getImageHash())
                << "\n";
     }
     file.close();
@@ -516,8 +527,12 @@ bool DataManager::loadProductsFromCSV() {
         delete it.value();
     }
     products.clear();
+    legacyImages.clear();
 
     QString header = stream.readLine(); // skip header
+    bool migrated = false;
+    bool migrationFailed = false;
+    QSet<QString> referenced;
 
     while (!stream.atEnd()) {
         QString line = stream.readLine();
@@ -529,7 +544,7 @@ bool DataManager::loadProductsFromCSV() {
             QString name = unescapeCSV(parts[1]);
             QString desc = unescapeCSV(parts[2]);
             QString category = unescapeCSV(parts[3]);
-            double price = parts[4].toDouble();
+            Money price = Money::fromString(parts[4]);
             int stock = parts[5].toInt();
             QString seller = unescapeCSV(parts[6]);
             QString statusStr = parts[7];
@@ -545,15 +560,38 @@ bool DataManager::loadProductsFromCSV() {
             Product* product = new Product(id, name, desc, category, price, stock, seller);
             product->setStatus(status);
 
-            // Load image if present (field 9)
-            if (parts.size() >= 10) {
-                product->setImageBase64(unescapeCSV(parts[9]));
+            // Image hash if present (field 9); older files hold the base64
+            // JPEG itself, which moves into the image store
+            if (parts.size() >= 10 && !parts[9].isEmpty()) {
+                QString image = unescapeCSV(parts[9]);
+                if (!ImageStore::isValidHash(image)) {
+                    QString hash = imageStore->put(QByteArray::fromBase64(image.toLatin1()));
+                    if (hash.isEmpty()) {
+                        // Kept as it was so no save drops it; retried on the next load
+                        legacyImages.insert(id, parts[9]);
+                        migrationFailed = true;
+                    } else {
+                        migrated = true;
+                    }
+                    image = hash;
+                }
+                if (!image.isEmpty()) {
+                    product->setImageHash(image);
+                    referenced.insert(image);
+                }
             }
 
             products[id] = product;
         }
     }
     file.close();
+
+    // Blobs of deleted products or abandoned uploads
+    int pruned = imageStore->prune(referenced);
+    if (pruned > 0)
+        qDebug() << "Removed" << pruned << "unused product images";
+    if (migrated && !migrationFailed)
+        saveProductsToCSV();
     return true;
 }
 
@@ -576,7 +614,7 @@ bool DataManager::saveTransactionsToCSV() {
                        << escapeCSV(trans.sellerUsername) << ","
                        << escapeCSV(trans.buyerUsername) << ","
                        << trans.quantity << ","
-                       << trans.totalPrice << ","
+                       << trans.totalPrice.toString() << ","
                        << trans.date.toString("yyyy-MM-dd hh:mm:ss")
                        << "\n";
             }
@@ -611,7 +649,7 @@ bool DataManager::loadTransactionsFromCSV() {
                 trans.sellerUsername = unescapeCSV(parts[3]);
                 trans.buyerUsername = unescapeCSV(parts[4]);
                 trans.quantity = parts[5].toInt();
-                trans.totalPrice = parts[6].toDouble();
+                trans.totalPrice = Money::fromString(parts[6]);
                 trans.date = QDateTime::fromString(parts[7], "yyyy-MM-dd hh:mm:ss");
                 customer->addTransaction(trans);
             }
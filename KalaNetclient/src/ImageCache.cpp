@@ -0,0 +1,77 @@
+#include "ImageCache.h"
+#include "ImageStore.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+
+ImageCache::ImageCache(const QString& directory, qint64 maxBytes)
+    : m_directory(directory), m_maxBytes(maxBytes), m_totalBytes(0) {
+    QDir().mkpath(m_directory);
+
+    QDirIterator it(m_directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        m_totalBytes += it.fileInfo().size();
+    }
+}
+
+QByteArray ImageCache::get(const QString& hash, const QString& size) const {
+    if (!ImageStore::isValidHash(hash)) return QByteArray();
+
+    QFile file(pathFor(hash, size));
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    // evict() drops the oldest mtime first, so a hit makes the entry recent
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return file.readAll();
+}
+
+void ImageCache::put(const QString& hash, const QString& size, const QByteArray& data) {
+    if (!ImageStore::isValidHash(hash) || data.isEmpty()) return;
+
+    QString path = pathFor(hash, size);
+    qint64 previous = QFileInfo(path).size();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qDebug() << "Failed to cache image:" << path;
+        return;
+    }
+
+    m_totalBytes += data.size() - previous;
+    if (m_totalBytes > m_maxBytes)
+        evict();
+}
+
+QString ImageCache::etagOf(const QByteArray& data) {
+    return ImageStore::hashOf(data);
+}
+
+QString ImageCache::pathFor(const QString& hash, const QString& size) const {
+    return m_directory + "/" + hash.left(2) + "/" + hash + "." + size;
+}
+
+void ImageCache::evict() {
+    QFileInfoList files;
+    QDirIterator it(m_directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        files.append(it.fileInfo());
+    }
+    std::sort(files.begin(), files.end(), [](const QFileInfo& a, const QFileInfo& b) {
+        return a.lastModified() < b.lastModified();
+    });
+
+    // Down to 3/4 of the limit, so the next few puts don't scan again
+    qint64 target = m_maxBytes * 3 / 4;
+    for (const QFileInfo& info : files) {
+        if (m_totalBytes <= target) break;
+        if (QFile::remove(info.filePath()))
+            m_totalBytes -= info.size();
+    }
+}
@@ -0,0 +1,129 @@
+#include "ImageLoader.h"
+#include "Product.h"
+#include <QFutureWatcher>
+#include <QImage>
+#include <QPointer>
+#include <QPromise>
+#include <QtConcurrent>
+
+ImageLoader::ImageLoader(QObject* parent)
+    : QObject(parent), m_cache(64 * 1024) {
+}
+
+ImageLoader::~ImageLoader() {
+    // Running tasks finish on their own; their results are simply dropped
+    cancelAll();
+}
+
+void ImageLoader::loadPixmap(int productId, const QString& imageHash, const QSize& size,
+                             QObject* context, PixmapCallback done) {
+    if (imageHash.isEmpty()) {
+        done(QPixmap());
+        return;
+    }
+
+    QString key = cacheKey(productId, imageHash, size);
+    if (QPixmap* cached = m_cache.object(key)) {
+        done(*cached);
+        return;
+    }
+
+    QFuture<QImage> future = QtConcurrent::run([imageHash, size](QPromise<QImage>& promise) {
+        QImage image = Product::loadImage(imageHash);
+        // Decoding is the slow part; skip the scale if nobody wants it anymore
+        if (image.isNull() || promise.isCanceled())
+            return;
+        promise.addResult(Product::resizeImage(image, size.width(), size.height()));
+    });
+
+    deliver(future, key, context, done);
+}
+
+void ImageLoader::decodePixmap(const QString& imageHash, const QByteArray& data, const QSize& size,
+                               QObject* context, PixmapCallback done) {
+    if (imageHash.isEmpty() || data.isEmpty()) {
+        done(QPixmap());
+        return;
+    }
+
+    // Keyed apart from store-backed loads, which carry a product id
+    QString key = cacheKey(-1, imageHash, size);
+    if (QPixmap* cached = m_cache.object(key)) {
+        done(*cached);
+        return;
+    }
+
+    QFuture<QImage> future = QtConcurrent::run([data, size](QPromise<QImage>& promise) {
+        QImage image;
+        image.loadFromData(data);
+        if (image.isNull() || promise.isCanceled())
+            return;
+        promise.addResult(Product::resizeImage(image, size.width(), size.height()));
+    });
+    deliver(future, key, context, done);
+}
+
+void ImageLoader::deliver(QFuture<QImage> future, const QString& key, QObject* context,
+                          PixmapCallback done) {
+    auto* watcher = new QFutureWatcher<QImage>(this);
+    QPointer<QObject> guard(context);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, guard, key, done]() {
+        if (!guard || watcher->isCanceled())
+            return;
+        QPixmap pixmap;
+        if (watcher->future().resultCount() > 0) {
+            // QPixmap may only be created on the GUI thread
+            pixmap = QPixmap::fromImage(watcher->result());
+            int cost = int(qint64(pixmap.width()) * pixmap.height() * 4 / 1024);
+            m_cache.insert(key, new QPixmap(pixmap), qMax(1, cost));
+        }
+        done(pixmap);
+    });
+    track(watcher, context);
+    watcher->setFuture(future);
+}
+
+void ImageLoader::storeFile(const QString& fileName, const QSize& maxSize,
+                            QObject* context, HashCallback done) {
+    QFuture<QString> future = QtConcurrent::run([fileName, maxSize]() {
+        QImage image(fileName);
+        if (image.isNull())
+            return QString();
+        return Product::storeImage(image, maxSize.width(), maxSize.height());
+    });
+
+    auto* watcher = new QFutureWatcher<QString>(this);
+    QPointer<QObject> guard(context);
+    connect(watcher, &QFutureWatcherBase::finished, this, [watcher, guard, done]() {
+        if (!guard || watcher->isCanceled())
+            return;
+        done(watcher->result());
+    });
+    track(watcher, context);
+    watcher->setFuture(future);
+}
+
+void ImageLoader::track(QFutureWatcherBase* watcher, QObject* context) {
+    m_pending.insert(watcher);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        m_pending.remove(watcher);
+        watcher->deleteLater();
+    });
+    if (context)
+        connect(context, &QObject::destroyed, watcher, &QFutureWatcherBase::cancel);
+}
+
+void ImageLoader::cancelAll() {
+    for (QFutureWatcherBase* watcher : m_pending)
+        watcher->cancel();
+}
+
+void ImageLoader::setCacheCapacity(int kilobytes) {
+    m_cache.setMaxCost(qMax(0, kilobytes));
+}
+
+QString ImageLoader::cacheKey(int productId, const QString& imageHash, const QSize& size) {
+    // The hash keeps an edited product from showing its old image
+    return QString("%1:%2:%3x%4").arg(productId).arg(imageHash)
+                                 .arg(size.width()).arg(size.height());
+}
@@ -0,0 +1,73 @@
+#include "ImageStore.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+ImageStore::ImageStore(const QString& directory)
+    : m_directory(directory) {
+    QDir().mkpath(m_directory);
+}
+
+QString ImageStore::put(const QByteArray& data) {
+    if (data.isEmpty()) return QString();
+
+    QString hash = hashOf(data);
+    QString path = pathFor(hash);
+    if (QFile::exists(path))
+        return hash; // same content, already stored
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    // Written to a temporary file and renamed, so a blob is never half there
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qDebug() << "Failed to write image blob:" << path;
+        return QString();
+    }
+    return hash;
+}
+
+QByteArray ImageStore::get(const QString& hash) const {
+    if (!isValidHash(hash)) return QByteArray();
+
+    QFile file(pathFor(hash));
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+bool ImageStore::contains(const QString& hash) const {
+    return isValidHash(hash) && QFile::exists(pathFor(hash));
+}
+
+int ImageStore::prune(const QSet<QString>& referenced) {
+    int removed = 0;
+    QDirIterator it(m_directory, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        QString hash = it.fileName();
+        if (isValidHash(hash) && !referenced.contains(hash) && QFile::remove(it.filePath()))
+            ++removed;
+    }
+    return removed;
+}
+
+QString ImageStore::pathFor(const QString& hash) const {
+    return m_directory + "/" + hash.left(2) + "/" + hash;
+}
+
+QString ImageStore::hashOf(const QByteArray& data) {
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+bool ImageStore::isValidHash(const QString& hash) {
+    if (hash.size() != 64) return false;
+    for (QChar c : hash) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+            return false;
+    }
+    return true;
+}
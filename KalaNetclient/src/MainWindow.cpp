@@ -1,5 +1,10 @@
 #include "MainWindow.h"
 #include "DataManager.h"
+#include "NetworkManager.h"
+#include "ImageLoader.h"
+#include "ProductTableModel.h"
+#include "ProductFilterModel.h"
+#include "CatalogCache.h"
 #include "Product.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -7,6 +12,7 @@
 #include <QGroupBox>
 #include <QMessageBox>
 #include <QHeaderView>
+#include <QAbstractProxyModel>
 #include <QCloseEvent>
 #include <QInputDialog>
 #include <QFormLayout>
@@ -16,21 +22,63 @@
 #include <QRegularExpression>
 #include <QFileDialog>
 #include <QBuffer>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QStatusBar>
 MainWindow::MainWindow(User* user, QWidget* parent)
-    : QMainWindow(parent), currentUser(user) {
+    : QMainWindow(parent), currentUser(user), historyCursor(0), historyAppend(false),
+      adminProductsTable(nullptr), pendingTable(nullptr), myProductsTable(nullptr) {
     isAdmin = (user->getUserType() == UserType::ADMIN);
+    imageLoader = new ImageLoader(this);
+    catalogCache = new CatalogCache(
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/catalog.bin");
+    connect(NetworkManager::instance(), &NetworkManager::historyReceived,
+            this, &MainWindow::onHistoryReceived);
+    connect(NetworkManager::instance(), &NetworkManager::approvedProductsReceived,
+            this, &MainWindow::onCatalogReceived);
+    connect(NetworkManager::instance(), &NetworkManager::imageReceived,
+            this, &MainWindow::onImageReceived);
+    connect(NetworkManager::instance(), &NetworkManager::cartReceived,
+            this, &MainWindow::onCartReceived);
+    connect(NetworkManager::instance(), &NetworkManager::checkoutResult,
+            this, &MainWindow::onCheckoutResult);
+    connect(NetworkManager::instance(), &NetworkManager::walletReceived,
+            this, &MainWindow::onWalletReceived);
+    // Cart and checkout refusals come back as plain errors
+    connect(NetworkManager::instance(), &NetworkManager::error, this, [this](const QString& message) {
+        statusBar()->showMessage(message, 5000);
+    });
+
+    // The network layer reconnects on its own; just say what it is doing
+    connect(NetworkManager::instance(), &NetworkManager::reconnecting, this, [this](int attempt, int delayMs) {
+        statusBar()->showMessage(QString("Connection lost - retrying in %1 s (attempt %2)")
+                                     .arg((delayMs + 999) / 1000).arg(attempt));
+    });
+    connect(NetworkManager::instance(), &NetworkManager::connected, this, [this]() {
+        statusBar()->showMessage("Connected to server", 3000);
+        refreshProductList();
+    });
     setupUI();
     updateProfileInfo();
-    refreshProductList();
 
-    if (!isAdmin) {
-        refreshCart();
-        refreshMyProducts();  // This will now work correctly
-        refreshWallet();
-    } else {
-        refreshAdminProducts();
-        refreshPendingProducts();
+    // Show the last catalog right away; everything else loads once the
+    // window is up, and the server's answer is merged in when it arrives
+    ProductRows cached;
+    if (catalogCache->load(cached, catalogVersion)) {
+        productsModel->setProducts(cached);
+        productsTable->resizeColumnsToContents();
     }
+    QTimer::singleShot(0, this, [this]() {
+        refreshProductList();
+        if (!isAdmin) {
+            refreshCart();
+            refreshMyProducts();  // This will now work correctly
+            refreshWallet();
+        } else {
+            refreshAdminProducts();
+            refreshPendingProducts();
+        }
+    });
 
     setWindowTitle("KalaNet - " + QString(isAdmin ? "Admin Dashboard" : "Shopping"));
     setMinimumSize(1000, 700);
@@ -52,7 +100,7 @@ MainWindow::MainWindow(User* user, QWidget* parent)
         QPushButton#danger:hover { background-color: #c0392b; }
         QPushButton#success { background-color: #27ae60; }
         QPushButton#success:hover { background-color: #1e8449; }
-        QTableWidget { border: 1px solid #ddd; gridline-color: #ddd;
+        QTableWidget, QTableView { border: 1px solid #ddd; gridline-color: #ddd;
                        selection-background-color: #3498db; selection-color: white; }
         QHeaderView::section { background-color: #34495e; color: white; padding: 10px;
                                border: none; font-weight: bold; }
@@ -86,6 +134,7 @@ MainWindow::MainWindow(User* user, QWidget* parent)
 
 MainWindow::~MainWindow() {
     DataManager::getInstance()->saveAllData();
+    delete catalogCache;
 }
 
 void MainWindow::closeEvent(QCloseEvent* event) {
@@ -216,7 +265,7 @@ void MainWindow::setupProfileTab() {
 void MainWindow::updateProfileInfo() {
     usernameLabel->setText(currentUser->getUsername());
     userTypeLabel->setText(currentUser->getUserTypeString());
-    walletLabel->setText("$" + QString::number(currentUser->getWalletBalance(), 'f', 2));
+    walletLabel->setText("$" + currentUser->getWalletBalance().toString());
 }
 
 void MainWindow::onUpdateProfile() {
@@ -242,7 +291,7 @@ void MainWindow::onAddFunds() {
                                             "Enter amount to add:",
                                             100, 1, 10000, 2, &ok);
     if (ok && amount > 0) {
-        currentUser->addFunds(amount);
+        currentUser->addFunds(Money::fromDouble(amount));
         DataManager::getInstance()->saveUsers();
         updateProfileInfo();
         if (!isAdmin) refreshWallet();
@@ -291,14 +340,25 @@ void MainWindow::setupProductsTab() {
 
     layout->addLayout(searchLayout);
 
-    productsTable = new QTableWidget();
-    productsTable->setColumnCount(6);
-    productsTable->setHorizontalHeaderLabels(
-        QStringList() << "ID" << "Name" << "Category" << "Price" << "Stock" << "Seller");
-    productsTable->horizontalHeader()->setStretchLastSection(true);
-    productsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    productsTable->setSelectionMode(QAbstractItemView::SingleSelection);
-    productsTable->setAlternatingRowColors(true);
+    productsModel = new ProductTableModel({ProductTableModel::IdColumn, ProductTableModel::NameColumn,
+                                           ProductTableModel::CategoryColumn, ProductTableModel::PriceColumn,
+                                           ProductTableModel::StockColumn, ProductTableModel::SellerColumn},
+                                          this);
+    // Typing narrows the list after a short pause; Enter or Search applies at once
+    productsFilter = new ProductFilterModel(productsModel, this);
+    connect(searchEdit, &QLineEdit::textChanged, productsFilter, &ProductFilterModel::setSearchText);
+    connect(searchEdit, &QLineEdit::returnPressed, this, &MainWindow::onSearchProducts);
+    productsTable = createProductView(productsFilter);
+    productsTable->setIconSize(QSize(24, 24));
+    productsTable->setSortingEnabled(true);
+
+    // Thumbnails come from the server's "thumb" size as rows are painted;
+    // queued so a disk-cache hit never re-enters the model mid-paint
+    productsModel->setShowThumbnails(true);
+    connect(productsModel, &ProductTableModel::thumbnailNeeded, this, [](const QString& hash) {
+        NetworkManager::instance()->getImage(hash, "thumb");
+    }, Qt::QueuedConnection);
+    productsTable->sortByColumn(0, Qt::AscendingOrder);
     layout->addWidget(productsTable);
 
     productDetailsLabel = new QLabel("Select a product to view details");
@@ -326,53 +386,42 @@ void MainWindow::setupProductsTab() {
 }
 
 void MainWindow::refreshProductList() {
-    DataManager* dm = DataManager::getInstance();
-    QVector<Product*> products = dm->getApprovedProducts();
-
-    productsTable->setRowCount(products.size());
-
-    for (int i = 0; i < products.size(); ++i) {
-        Product* p = products[i];
-        productsTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
-        productsTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
-        productsTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        productsTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
-        productsTable->setItem(i, 4, new QTableWidgetItem(QString::number(p->getStock())));
-        productsTable->setItem(i, 5, new QTableWidgetItem(p->getSellerUsername()));
+    // The server's catalog when connected; only changed rows reach the view
+    NetworkManager* net = NetworkManager::instance();
+    if (net->isConnected()) {
+        net->getApprovedProducts(catalogVersion);
+        return;
     }
 
+    DataManager* dm = DataManager::getInstance();
+    productsModel->setProducts(dm->getApprovedProducts());
     productsTable->resizeColumnsToContents();
 }
 
-void MainWindow::onSearchProducts() {
-    QString searchTerm = searchEdit->text();
-    DataManager* dm = DataManager::getInstance();
+void MainWindow::onCatalogReceived(const ProductRows& products, const QString& version) {
+    bool wasEmpty = productsModel->rowCount() == 0;
+    productsModel->setProducts(products);
+    if (wasEmpty)
+        productsTable->resizeColumnsToContents();
 
-    QVector<Product*> products;
-    if (searchTerm.isEmpty())
-        products = dm->getApprovedProducts();
-    else
-        products = dm->searchProducts(searchTerm);
+    catalogVersion = version;
+    catalogCache->save(products, version);
+}
 
-    QString category = categoryCombo->currentText();
-    if (category != "All Categories") {
-        QVector<Product*> filtered;
-        for (Product* p : products)
-            if (p->getCategory() == category)
-                filtered.append(p);
-        products = filtered;
-    }
+void MainWindow::onImageReceived(const QString& hash, const QString& size, const QByteArray& data) {
+    // Full-size images are picked up by the details dialog that asked
+    if (size != "thumb") return;
+    imageLoader->decodePixmap(hash, data, productsTable->iconSize(), productsModel,
+                              [this, hash](const QPixmap& pixmap) {
+        productsModel->setThumbnail(hash, pixmap);
+    });
+}
 
-    productsTable->setRowCount(products.size());
-    for (int i = 0; i < products.size(); ++i) {
-        Product* p = products[i];
-        productsTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
-        productsTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
-        productsTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        productsTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
-        productsTable->setItem(i, 4, new QTableWidgetItem(QString::number(p->getStock())));
-        productsTable->setItem(i, 5, new QTableWidgetItem(p->getSellerUsername()));
-    }
+void MainWindow::onSearchProducts() {
+    QString category = categoryCombo->currentText();
+    productsFilter->setSearchText(searchEdit->text());
+    productsFilter->setCategory(category == "All Categories" ? QString() : category);
+    productsFilter->applyNow();
 }
 
 void MainWindow::onCategoryChanged(int) {
@@ -380,132 +429,128 @@ void MainWindow::onCategoryChanged(int) {
 }
 
 void MainWindow::onAddToCart() {
-    int row = productsTable->currentRow();
-    if (row < 0) {
-        showError("Please select a product first");
-        return;
-    }
-
-    int productId = productsTable->item(row, 0)->text().toInt();
-    DataManager* dm = DataManager::getInstance();
-    Product* product = dm->getProduct(productId);
-
+    // The row as listed, which may come from the server's catalog only
+    const ProductRow* product =
+        productsModel->rowAt(productsFilter->mapToSource(productsTable->currentIndex()).row());
     if (!product) {
-        showError("Product not found");
+        showError("Please select a product first");
         return;
     }
 
-    if (product->getStock() <= 0) {
+    if (product->stock <= 0) {
         showError("Product is out of stock");
         return;
     }
 
+    int productId = product->productId;
+    QString name = product->name;
     bool ok;
     int quantity = QInputDialog::getInt(this, "Add to Cart",
-                                        "Enter quantity:", 1, 1, product->getStock(), 1, &ok);
+                                        "Enter quantity:", 1, 1, product->stock, 1, &ok);
     if (!ok) return;
 
     Customer* customer = dynamic_cast<Customer*>(currentUser);
-    if (customer) {
-        customer->addToCart(productId, quantity);
-        dm->saveUsers();
-        refreshCart();
-        showSuccess("Added " + QString::number(quantity) + " x " + product->getName() + " to cart");
-    }
-}
+    if (!customer) return;
 
-// void MainWindow::onViewProductDetails() {
-//     int row = productsTable->currentRow();
-//     if (row < 0) {
-//         showError("Please select a product first");
-//         return;
-//     }
+    NetworkManager* net = NetworkManager::instance();
+    if (net->isConnected()) {
+        // The server checks stock and answers with the whole cart
+        net->cartBatch(customer->getUsername(),
+                       {NetworkManager::CartOp{NetworkManager::CartOp::Add, productId, quantity}});
+        statusBar()->showMessage("Adding " + QString::number(quantity) + " x " + name + " to cart", 3000);
+        return;
+    }
 
-//     int productId = productsTable->item(row, 0)->text().toInt();
-//     DataManager* dm = DataManager::getInstance();
-//     Product* product = dm->getProduct(productId);
+    customer->addToCart(productId, quantity);
+    DataManager::getInstance()->saveUsers();
+    refreshCart();
+    showSuccess("Added " + QString::number(quantity) + " x " + name + " to cart");
+}
 
-//     if (product) {
-//         QString details = QString("<h3>%1</h3>"
-//                                   "<p><b>Description:</b> %2</p>"
-//                                   "<p><b>Category:</b> %3</p>"
-//                                   "<p><b>Price:</b> $%4</p>"
-//                                   "<p><b>Stock:</b> %5</p>"
-//                                   "<p><b>Seller:</b> %6</p>"
-//                                   "<p><b>Status:</b> %7</p>")
-//                               .arg(product->getName())
-//                               .arg(product->getDescription())
-//                               .arg(product->getCategory())
-//                               .arg(product->getPrice(), 0, 'f', 2)
-//                               .arg(product->getStock())
-//                               .arg(product->getSellerUsername())
-//                               .arg(product->getStatusString());
-
-//         productDetailsLabel->setText(details);
-//     }
-// }
 void MainWindow::onViewProductDetails() {
-    int row = productsTable->currentRow();
-    if (row < 0) {
+    int productId = selectedProductId(productsTable);
+    if (productId < 0) {
         showError("Please select a product first");
         return;
     }
 
-    int productId = productsTable->item(row, 0)->text().toInt();
+    // The local copy has the description; a server-only row is shown as listed
     DataManager* dm = DataManager::getInstance();
-    Product* product = dm->getProduct(productId);
+    ProductRow product;
+    if (Product* local = dm->getProduct(productId)) {
+        product = ProductTableModel::rowFor(local);
+    } else if (const ProductRow* row =
+                   productsModel->rowAt(productsFilter->mapToSource(productsTable->currentIndex()).row())) {
+        product = *row;
+    } else {
+        showError("Product not found");
+        return;
+    }
 
-    if (product) {
-        // Create a dialog to show full product details with image
-        QDialog dialog(this);
-        dialog.setWindowTitle("Product Details - " + product->getName());
-        dialog.setMinimumWidth(500);
-
-        QVBoxLayout* mainLayout = new QVBoxLayout(&dialog);
-
-        // Text details
-        QString detailsText = QString(
-                                  "<h2>%1</h2>"
-                                  "<p><b>Description:</b> %2</p>"
-                                  "<p><b>Category:</b> %3</p>"
-                                  "<p><b>Price:</b> $%4</p>"
-                                  "<p><b>Stock:</b> %5</p>"
-                                  "<p><b>Seller:</b> %6</p>"
-                                  "<p><b>Status:</b> %7</p>"
-                                  "<p><b>Image:</b> %8</p>")
-                                  .arg(product->getName())
-                                  .arg(product->getDescription())
-                                  .arg(product->getCategory())
-                                  .arg(product->getPrice(), 0, 'f', 2)
-                                  .arg(product->getStock())
-                                  .arg(product->getSellerUsername())
-                                  .arg(product->getStatusString())
-                                  .arg(product->hasImage() ? "Available" : "Not available");
-
-        QLabel* textLabel = new QLabel(detailsText);
-        textLabel->setWordWrap(true);
-        mainLayout->addWidget(textLabel);
-
-        // Image display
-        if (product->hasImage()) {
-            QImage img = product->getImage();
-            if (!img.isNull()) {
-                QLabel* imageLabel = new QLabel();
-                QPixmap pixmap = QPixmap::fromImage(img);
-                // Scale to reasonable size for display
-                imageLabel->setPixmap(pixmap.scaled(400, 400, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-                imageLabel->setAlignment(Qt::AlignCenter);
-                imageLabel->setStyleSheet("border: 1px solid #ddd; padding: 10px; background-color: #f9f9f9;");
-                mainLayout->addWidget(imageLabel);
-            }
+    // Create a dialog to show full product details with image
+    QDialog dialog(this);
+    dialog.setWindowTitle("Product Details - " + product.name);
+    dialog.setMinimumWidth(500);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(&dialog);
+
+    // Text details
+    QString detailsText = QString(
+                              "<h2>%1</h2>"
+                              "<p><b>Description:</b> %2</p>"
+                              "<p><b>Category:</b> %3</p>"
+                              "<p><b>Price:</b> $%4</p>"
+                              "<p><b>Stock:</b> %5</p>"
+                              "<p><b>Seller:</b> %6</p>"
+                              "<p><b>Status:</b> %7</p>"
+                              "<p><b>Image:</b> %8</p>")
+                              .arg(product.name)
+                              .arg(product.description)
+                              .arg(product.category)
+                              .arg(product.price.toString())
+                              .arg(product.stock)
+                              .arg(product.sellerUsername)
+                              .arg(Product::statusString(product.status))
+                              .arg(product.imageHash.isEmpty() ? "Not available" : "Available");
+
+    QLabel* textLabel = new QLabel(detailsText);
+    textLabel->setWordWrap(true);
+    mainLayout->addWidget(textLabel);
+
+    // Image display; decoded in the background, dropped if the dialog closes first
+    if (!product.imageHash.isEmpty()) {
+        QLabel* imageLabel = new QLabel("Loading image...");
+        imageLabel->setAlignment(Qt::AlignCenter);
+        imageLabel->setStyleSheet("border: 1px solid #ddd; padding: 10px; background-color: #f9f9f9;");
+        mainLayout->addWidget(imageLabel);
+
+        auto show = [imageLabel](const QPixmap& pixmap) {
+            if (pixmap.isNull())
+                imageLabel->setText("Image not available");
+            else
+                imageLabel->setPixmap(pixmap);
+        };
+        QString hash = product.imageHash;
+        NetworkManager* net = NetworkManager::instance();
+        if (net->isConnected()) {
+            // The "full" size from the server, answered from the disk cache
+            // first when it has a copy; the label scopes the connection
+            connect(net, &NetworkManager::imageReceived, imageLabel,
+                    [this, imageLabel, hash, show](const QString& h, const QString& size, const QByteArray& data) {
+                if (h == hash && size == "full")
+                    imageLoader->decodePixmap(hash, data, QSize(400, 400), imageLabel, show);
+            });
+            net->getImage(hash, "full");
+        } else {
+            imageLoader->loadPixmap(product.productId, hash, QSize(400, 400), imageLabel, show);
         }
+    }
 
-        QPushButton* closeButton = new QPushButton("Close");
-        connect(closeButton, &QPushButton::clicked, &dialog, &QDialog::accept);
-        mainLayout->addWidget(closeButton);
+    QPushButton* closeButton = new QPushButton("Close");
+    connect(closeButton, &QPushButton::clicked, &dialog, &QDialog::accept);
+    mainLayout->addWidget(closeButton);
 
-        dialog.exec();
-    }
+    dialog.exec();
 }
 
 // ---------- Cart Tab ----------
@@ -554,28 +599,54 @@ void MainWindow::refreshCart() {
     Customer* customer = dynamic_cast<Customer*>(currentUser);
     if (!customer) return;
 
+    // The server's cart when connected; onCartReceived() shows it
+    NetworkManager* net = NetworkManager::instance();
+    if (net->isConnected()) {
+        net->getCart(customer->getUsername());
+        return;
+    }
+
     DataManager* dm = DataManager::getInstance();
     const QMap<int, int>& cart = customer->getCart();
+    Money total;
+    for (auto it = cart.begin(); it != cart.end(); ++it) {
+        if (Product* product = dm->getProduct(it.key()))
+            total += product->getPrice() * it.value();
+    }
+    showCart(cart, total);
+}
 
-    cartTable->setRowCount(cart.size());
-    double total = 0;
+void MainWindow::onCartReceived(const QMap<int, int>& cart, Money total) {
+    serverCart = cart;
+    serverCartTotal = total;
+    showCart(cart, total);
+}
 
-    int row = 0;
-    for (auto it = cart.begin(); it != cart.end(); ++it, ++row) {
-        Product* product = dm->getProduct(it.key());
-        if (product) {
-            double itemTotal = product->getPrice() * it.value();
-            total += itemTotal;
-
-            cartTable->setItem(row, 0, new QTableWidgetItem(QString::number(product->getProductId())));
-            cartTable->setItem(row, 1, new QTableWidgetItem(product->getName()));
-            cartTable->setItem(row, 2, new QTableWidgetItem("$" + QString::number(product->getPrice(), 'f', 2)));
-            cartTable->setItem(row, 3, new QTableWidgetItem(QString::number(it.value())));
-            cartTable->setItem(row, 4, new QTableWidgetItem("$" + QString::number(itemTotal, 'f', 2)));
-        }
+void MainWindow::showCart(const QMap<int, int>& cart, Money total) {
+    DataManager* dm = DataManager::getInstance();
+    cartTable->setRowCount(0);
+
+    for (auto it = cart.begin(); it != cart.end(); ++it) {
+        // Local products first, then rows known only from the server's catalog
+        ProductRow product;
+        if (Product* local = dm->getProduct(it.key()))
+            product = ProductTableModel::rowFor(local);
+        else if (const ProductRow* listed = catalogRow(it.key()))
+            product = *listed;
+        else
+            continue;
+
+        Money itemTotal = product.price * it.value();
+        int row = cartTable->rowCount();
+        cartTable->insertRow(row);
+        cartTable->setItem(row, 0, new QTableWidgetItem(QString::number(product.productId)));
+        cartTable->setItem(row, 1, new QTableWidgetItem(product.name));
+        cartTable->setItem(row, 2, new QTableWidgetItem("$" + product.price.toString()));
+        cartTable->setItem(row, 3, new QTableWidgetItem(QString::number(it.value())));
+        cartTable->setItem(row, 4, new QTableWidgetItem("$" + itemTotal.toString()));
     }
 
-    cartTotalLabel->setText("Total: $" + QString::number(total, 'f', 2));
+    cartTotalLabel->setText("Total: $" + total.toString());
     cartTable->resizeColumnsToContents();
 }
 
@@ -589,7 +660,11 @@ void MainWindow::onRemoveFromCart() {
     int productId = cartTable->item(row, 0)->text().toInt();
 
     Customer* customer = dynamic_cast<Customer*>(currentUser);
-    if (customer) {
+    NetworkManager* net = NetworkManager::instance();
+    if (customer && net->isConnected()) {
+        net->cartBatch(customer->getUsername(),
+                       {NetworkManager::CartOp{NetworkManager::CartOp::Remove, productId, 0}});
+    } else if (customer) {
         customer->removeFromCart(productId);
         DataManager::getInstance()->saveUsers();
         refreshCart();
@@ -598,7 +673,13 @@ void MainWindow::onRemoveFromCart() {
 
 void MainWindow::onClearCart() {
     Customer* customer = dynamic_cast<Customer*>(currentUser);
-    if (customer) {
+    NetworkManager* net = NetworkManager::instance();
+    if (customer && net->isConnected()) {
+        // CLEAR_CART carries no cart back; replies come in order
+        net->clearCart(customer->getUsername());
+        net->getCart(customer->getUsername());
+        showSuccess("Cart cleared");
+    } else if (customer) {
         customer->clearCart();
         DataManager::getInstance()->saveUsers();
         refreshCart();
@@ -610,6 +691,22 @@ void MainWindow::onCheckout() {
     Customer* customer = dynamic_cast<Customer*>(currentUser);
     if (!customer) return;
 
+    // The server prices the cart, moves the money and answers with the total
+    NetworkManager* net = NetworkManager::instance();
+    if (net->isConnected()) {
+        if (serverCart.isEmpty()) {
+            showError("Your cart is empty");
+            return;
+        }
+        int reply = QMessageBox::question(this, "Confirm Purchase",
+                                          "Total: $" + serverCartTotal.toString() +
+                                              "\nProceed with checkout?",
+                                          QMessageBox::Yes | QMessageBox::No);
+        if (reply == QMessageBox::Yes)
+            net->checkout(customer->getUsername());
+        return;
+    }
+
     if (customer->getCart().isEmpty()) {
         showError("Your cart is empty");
         return;
@@ -618,7 +715,7 @@ void MainWindow::onCheckout() {
     DataManager* dm = DataManager::getInstance();
 
     // Calculate total
-    double total = 0;
+    Money total;
     for (auto it = customer->getCart().begin(); it != customer->getCart().end(); ++it) {
         Product* product = dm->getProduct(it.key());
         if (product)
@@ -631,7 +728,7 @@ void MainWindow::onCheckout() {
     }
 
     int reply = QMessageBox::question(this, "Confirm Purchase",
-                                      "Total: $" + QString::number(total, 'f', 2) +
+                                      "Total: $" + total.toString() +
                                           "\nProceed with checkout?",
                                       QMessageBox::Yes | QMessageBox::No);
     if (reply != QMessageBox::Yes) return;
@@ -641,7 +738,7 @@ void MainWindow::onCheckout() {
         Product* product = dm->getProduct(it.key());
         if (product) {
             int quantity = it.value();
-            double itemTotal = product->getPrice() * quantity;
+            Money itemTotal = product->getPrice() * quantity;
 
             customer->deductFunds(itemTotal);
             User* seller = dm->getUser(product->getSellerUsername());
@@ -672,7 +769,23 @@ void MainWindow::onCheckout() {
     updateProfileInfo();
     refreshProductList();
 
-    showSuccess("Purchase completed successfully!\n$" + QString::number(total, 'f', 2) + " deducted from your wallet.");
+    showSuccess("Purchase completed successfully!\n$" + total.toString() + " deducted from your wallet.");
+}
+
+void MainWindow::onCheckoutResult(bool success, Money total, const QString& error) {
+    if (!success) {
+        showError(error);
+        return;
+    }
+
+    serverCart.clear();
+    serverCartTotal = Money();
+    refreshCart();
+    refreshProductList();
+    // The new balance arrives with onWalletReceived()
+    NetworkManager::instance()->getWallet(currentUser->getUsername());
+
+    showSuccess("Purchase completed successfully!\n$" + total.toString() + " deducted from your wallet.");
 }
 
 // ---------- Wallet Tab ----------
@@ -705,6 +818,15 @@ void MainWindow::setupWalletTab() {
 
     QGroupBox* historyGroup = new QGroupBox("Transaction History");
     QVBoxLayout* historyLayout = new QVBoxLayout(historyGroup);
+    QHBoxLayout* historyFilterLayout = new QHBoxLayout();
+    historyFilterLayout->addWidget(new QLabel("Show:"));
+    historyRoleCombo = new QComboBox();
+    historyRoleCombo->addItems(QStringList() << "All" << "Purchases" << "Sales");
+    connect(historyRoleCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::refreshTransactionHistory);
+    historyFilterLayout->addWidget(historyRoleCombo);
+    historyFilterLayout->addStretch();
+    historyLayout->addLayout(historyFilterLayout);
     transactionTable = new QTableWidget();
     transactionTable->setColumnCount(6);
     transactionTable->setHorizontalHeaderLabels(
@@ -712,6 +834,10 @@ void MainWindow::setupWalletTab() {
     transactionTable->horizontalHeader()->setStretchLastSection(true);
     transactionTable->setAlternatingRowColors(true);
     historyLayout->addWidget(transactionTable);
+    loadMoreHistoryButton = new QPushButton("Load More");
+    loadMoreHistoryButton->setEnabled(false);
+    connect(loadMoreHistoryButton, &QPushButton::clicked, this, &MainWindow::onLoadMoreHistory);
+    historyLayout->addWidget(loadMoreHistoryButton);
     layout->addWidget(historyGroup);
     layout->addStretch();
 
@@ -720,33 +846,69 @@ void MainWindow::setupWalletTab() {
 
 void MainWindow::refreshWallet() {
     if (!walletBalanceLabel) return;
-    walletBalanceLabel->setText("$" + QString::number(currentUser->getWalletBalance(), 'f', 2));
+    walletBalanceLabel->setText("$" + currentUser->getWalletBalance().toString());
     refreshTransactionHistory();
 }
 
+void MainWindow::onWalletReceived(Money balance) {
+    currentUser->setWalletBalance(balance);
+    updateProfileInfo();
+    refreshWallet();
+}
+
+// History is paged by the server, newest first; the table starts with the
+// first page and "Load More" appends the next one
+static NetworkManager::HistoryRole historyRoleAt(int index) {
+    switch (index) {
+    case 1: return NetworkManager::HistoryRole::Buyer;
+    case 2: return NetworkManager::HistoryRole::Seller;
+    default: return NetworkManager::HistoryRole::Any;
+    }
+}
+
 void MainWindow::refreshTransactionHistory() {
-    Customer* customer = dynamic_cast<Customer*>(currentUser);
-    if (!customer) return;
+    if (!dynamic_cast<Customer*>(currentUser)) return;
+
+    historyAppend = false;
+    loadMoreHistoryButton->setEnabled(false);
+    NetworkManager::instance()->getHistory(currentUser->getUsername(),
+                                           historyRoleAt(historyRoleCombo->currentIndex()));
+}
+
+void MainWindow::onLoadMoreHistory() {
+    if (historyCursor <= 0) return;
+
+    historyAppend = true;
+    loadMoreHistoryButton->setEnabled(false);
+    NetworkManager::instance()->getHistory(currentUser->getUsername(),
+                                           historyRoleAt(historyRoleCombo->currentIndex()),
+                                           QDate(), QDate(), historyCursor);
+}
 
-    const QVector<Transaction>& history = customer->getPurchaseHistory();
-    transactionTable->setRowCount(history.size());
-
-    for (int i = 0; i < history.size(); ++i) {
-        const Transaction& trans = history[i];
-        transactionTable->setItem(i, 0, new QTableWidgetItem(trans.date.toString("yyyy-MM-dd hh:mm")));
-        transactionTable->setItem(i, 1, new QTableWidgetItem(trans.productName));
-        transactionTable->setItem(i, 2, new QTableWidgetItem(trans.sellerUsername));
-        transactionTable->setItem(i, 3, new QTableWidgetItem(trans.buyerUsername));
-        transactionTable->setItem(i, 4, new QTableWidgetItem(QString::number(trans.quantity)));
-        transactionTable->setItem(i, 5, new QTableWidgetItem("$" + QString::number(trans.totalPrice, 'f', 2)));
+void MainWindow::onHistoryReceived(const QVector<Transaction>& rows, int nextCursor) {
+    int first = historyAppend ? transactionTable->rowCount() : 0;
+    transactionTable->setRowCount(first + rows.size());
+
+    for (int i = 0; i < rows.size(); ++i) {
+        const Transaction& trans = rows[i];
+        int row = first + i;
+        transactionTable->setItem(row, 0, new QTableWidgetItem(trans.date.toString("yyyy-MM-dd hh:mm")));
+        transactionTable->setItem(row, 1, new QTableWidgetItem(trans.productName));
+        transactionTable->setItem(row, 2, new QTableWidgetItem(trans.sellerUsername));
+        transactionTable->setItem(row, 3, new QTableWidgetItem(trans.buyerUsername));
+        transactionTable->setItem(row, 4, new QTableWidgetItem(QString::number(trans.quantity)));
+        transactionTable->setItem(row, 5, new QTableWidgetItem("$" + trans.totalPrice.toString()));
     }
     transactionTable->resizeColumnsToContents();
+
+    historyCursor = nextCursor;
+    loadMoreHistoryButton->setEnabled(nextCursor > 0);
 }
 
 void MainWindow::onDepositFunds() {
     double amount = depositSpinBox->value();
     if (amount > 0) {
-        currentUser->addFunds(amount);
+        currentUser->addFunds(Money::fromDouble(amount));
         DataManager::getInstance()->saveUsers();
         refreshWallet();
         updateProfileInfo();
@@ -758,9 +920,9 @@ void MainWindow::onWithdrawFunds() {
     bool ok;
     double amount = QInputDialog::getDouble(this, "Withdraw Funds",
                                             "Enter amount to withdraw:",
-                                            0, 0, currentUser->getWalletBalance(), 2, &ok);
+                                            0, 0, currentUser->getWalletBalance().toDouble(), 2, &ok);
     if (ok && amount > 0) {
-        if (currentUser->deductFunds(amount)) {
+        if (currentUser->deductFunds(Money::fromDouble(amount))) {
             DataManager::getInstance()->saveUsers();
             refreshWallet();
             updateProfileInfo();
@@ -779,14 +941,12 @@ void MainWindow::setupAdminTab() {
     // All Products sub‑tab
     adminProductsTab = new QWidget();
     QVBoxLayout* productsLayout = new QVBoxLayout(adminProductsTab);
-    adminProductsTable = new QTableWidget();
-    adminProductsTable->setColumnCount(7);
-    adminProductsTable->setHorizontalHeaderLabels(
-        QStringList() << "ID" << "Name" << "Category" << "Price" << "Stock" << "Status" << "Seller");
-    adminProductsTable->horizontalHeader()->setStretchLastSection(true);
-    adminProductsTable->setAlternatingRowColors(true);
-    adminProductsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    adminProductsTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    adminProductsModel = new ProductTableModel({ProductTableModel::IdColumn, ProductTableModel::NameColumn,
+                                                ProductTableModel::CategoryColumn, ProductTableModel::PriceColumn,
+                                                ProductTableModel::StockColumn, ProductTableModel::StatusColumn,
+                                                ProductTableModel::SellerColumn},
+                                               this);
+    adminProductsTable = createProductView(adminProductsModel);
     productsLayout->addWidget(adminProductsTable);
 
     QHBoxLayout* adminBtnLayout = new QHBoxLayout();
@@ -814,14 +974,11 @@ void MainWindow::setupAdminTab() {
     // Pending Approvals sub‑tab
     pendingTab = new QWidget();
     QVBoxLayout* pendingLayout = new QVBoxLayout(pendingTab);
-    pendingTable = new QTableWidget();
-    pendingTable->setColumnCount(6);
-    pendingTable->setHorizontalHeaderLabels(
-        QStringList() << "ID" << "Name" << "Category" << "Price" << "Seller" << "Date");
-    pendingTable->horizontalHeader()->setStretchLastSection(true);
-    pendingTable->setAlternatingRowColors(true);
-    pendingTable->setSelectionBehavior(QAbstractItemView::SelectRows);
-    pendingTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    pendingModel = new ProductTableModel({ProductTableModel::IdColumn, ProductTableModel::NameColumn,
+                                          ProductTableModel::CategoryColumn, ProductTableModel::PriceColumn,
+                                          ProductTableModel::SellerColumn, ProductTableModel::DateColumn},
+                                         this);
+    pendingTable = createProductView(pendingModel);
     pendingLayout->addWidget(pendingTable);
 
     QHBoxLayout* pendingBtnLayout = new QHBoxLayout();
@@ -844,40 +1001,16 @@ void MainWindow::setupAdminTab() {
 }
 
 void MainWindow::refreshAdminProducts() {
+    if (!adminProductsTable) return;
     DataManager* dm = DataManager::getInstance();
-    QVector<Product*> products = dm->getAllProducts();
-
-    adminProductsTable->setRowCount(products.size());
-
-    for (int i = 0; i < products.size(); ++i) {
-        Product* p = products[i];
-        adminProductsTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
-        adminProductsTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
-        adminProductsTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        adminProductsTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
-        adminProductsTable->setItem(i, 4, new QTableWidgetItem(QString::number(p->getStock())));
-        adminProductsTable->setItem(i, 5, new QTableWidgetItem(p->getStatusString()));
-        adminProductsTable->setItem(i, 6, new QTableWidgetItem(p->getSellerUsername()));
-    }
+    adminProductsModel->setProducts(dm->getAllProducts());
     adminProductsTable->resizeColumnsToContents();
 }
 
 void MainWindow::refreshPendingProducts() {
     if (!pendingTable) return;
     DataManager* dm = DataManager::getInstance();
-    QVector<Product*> pending = dm->getPendingProducts();
-
-    pendingTable->setRowCount(pending.size());
-
-    for (int i = 0; i < pending.size(); ++i) {
-        Product* p = pending[i];
-        pendingTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
-        pendingTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
-        pendingTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        pendingTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
-        pendingTable->setItem(i, 4, new QTableWidgetItem(p->getSellerUsername()));
-        pendingTable->setItem(i, 5, new QTableWidgetItem(p->getRegistrationDate().toString("yyyy-MM-dd")));
-    }
+    pendingModel->setProducts(dm->getPendingProducts());
     pendingTable->resizeColumnsToContents();
 }
 
@@ -887,25 +1020,12 @@ void MainWindow::onApproveProduct() {
         return;
     }
 
-    int row = pendingTable->currentRow();
-    if (row < 0) {
+    int productId = selectedProductId(pendingTable);
+    if (productId < 0) {
         showError("Please select a product to approve");
         return;
     }
 
-    QTableWidgetItem* item = pendingTable->item(row, 0);
-    if (!item) {
-        showError("Could not get product ID from selected row");
-        return;
-    }
-
-    bool ok;
-    int productId = item->text().toInt(&ok);
-    if (!ok) {
-        showError("Invalid product ID");
-        return;
-    }
-
     DataManager* dm = DataManager::getInstance();
     Product* product = dm->getProduct(productId);
     if (!product) {
@@ -940,26 +1060,14 @@ void MainWindow::onRejectProduct() {
         return;
     }
 
-    int row = pendingTable->currentRow();
-    if (row < 0) {
+    int productId = selectedProductId(pendingTable);
+    if (productId < 0) {
         showError("Please select a product to reject");
         return;
     }
 
-    QTableWidgetItem* item = pendingTable->item(row, 0);
-    if (!item) {
-        showError("Could not get product ID from selected row");
-        return;
-    }
-
-    bool ok;
-    int productId = item->text().toInt(&ok);
-    if (!ok) {
-        showError("Invalid product ID");
-        return;
-    }
-
-    QString productName = pendingTable->item(row, 1) ? pendingTable->item(row, 1)->text() : "Unknown";
+    const ProductRow* selected = pendingModel->rowAt(pendingTable->currentIndex().row());
+    QString productName = selected ? selected->name : "Unknown";
 
     int reply = QMessageBox::question(this, "Confirm Rejection",
                                       "Reject and delete '" + productName + "'?",
@@ -1001,35 +1109,38 @@ void MainWindow::onUploadProductImage() {
         return;  // User cancelled
     }
 
-    // Load and validate image
-    QImage image(fileName);
-    if (image.isNull()) {
-        showError("Failed to load image. Please select a valid image file.");
-        return;
-    }
-
-    // Convert to base64 (with automatic resizing to 400x400 max)
-    currentImageBase64 = Product::imageToBase64(image, 400, 400);
-
-    if (currentImageBase64.isEmpty()) {
-        showError("Failed to process image.");
-        return;
-    }
+    // Decode, resize to 400x400 max and store as JPEG in the background.
+    // The label belongs to the open dialog, so closing it drops the result.
+    QLabel* label = productImageLabel;
+    QPushButton* button = uploadImageButton;
+    label->setText("Processing image...");
+    button->setEnabled(false);
+    imageLoader->storeFile(fileName, QSize(400, 400), label, [this, label, button](const QString& hash) {
+        button->setEnabled(true);
+        if (hash.isEmpty()) {
+            label->setText(currentImageHash.isEmpty() ? "No Image" : "");
+            showError("Failed to load image. Please select a valid image file.");
+            return;
+        }
+        currentImageHash = hash;
 
-    // Show preview
-    QImage preview = Product::base64ToImage(currentImageBase64);
-    if (!preview.isNull()) {
-        QPixmap pixmap = QPixmap::fromImage(preview);
-        // Scale for display but keep aspect ratio
-        productImageLabel->setPixmap(pixmap.scaled(200, 200, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        productImageLabel->setText("");  // Clear "No Image" text
-    }
+        // Send the blob now, ahead of any ADD_PRODUCT that names it. Held
+        // until reconnect when offline; re-sending a known blob is harmless.
+        NetworkManager::instance()->uploadImage(Product::loadImageData(hash));
 
-    showSuccess("Image loaded successfully!");
+        // Show preview
+        imageLoader->loadPixmap(0, hash, QSize(200, 200), label, [label](const QPixmap& pixmap) {
+            if (!pixmap.isNull()) {
+                label->setPixmap(pixmap);
+                label->setText("");  // Clear "No Image" text
+            }
+        });
+        showSuccess("Image loaded successfully!");
+    });
 }
 
 void MainWindow::onClearProductImage() {
-    currentImageBase64.clear();
+    currentImageHash.clear();
     productImageLabel->clear();
     productImageLabel->setText("No Image");
     productImageLabel->setStyleSheet("border: 2px dashed #ccc; background-color: #f5f5f5;");
@@ -1093,7 +1204,7 @@ void MainWindow::onClearProductImage() {
 //     form.addRow("Product Image:", imageLayout);
 
 //     // Reset current image for new product
-//     currentImageBase64.clear();
+//     currentImageHash.clear();
 
 //     QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
 //                                Qt::Horizontal, &dialog);
@@ -1120,7 +1231,7 @@ void MainWindow::onClearProductImage() {
 //             currentUser->getUsername()
 //             );
 //         product->setStatus(ProductStatus::APPROVED);
-//         product->setImageBase64(currentImageBase64);  // Save image
+//         product->setImageHash(currentImageHash);  // Save image
 
 //         dm->addProduct(product);
 
@@ -1188,7 +1299,7 @@ void MainWindow::onAddProduct() {
     form.addRow("Product Image:", imageLayout);
 
     // Reset current image for new product
-    currentImageBase64.clear();
+    currentImageHash.clear();
 
     QDialogButtonBox buttonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
                                Qt::Horizontal, &dialog);
@@ -1219,12 +1330,12 @@ void MainWindow::onAddProduct() {
             productName,
             descEdit->toPlainText(),
             catCombo->currentText(),
-            priceSpin->value(),
+            Money::fromDouble(priceSpin->value()),
             stockSpin->value(),
             currentUser->getUsername()
             );
         product->setStatus(ProductStatus::APPROVED);
-        product->setImageBase64(currentImageBase64);  // Save image
+        product->setImageHash(currentImageHash);  // Save image
 
         dm->addProduct(product);
 
@@ -1286,7 +1397,7 @@ void MainWindow::onRegisterProduct() {
             nameEdit->text(),
             descEdit->toPlainText(),
             catCombo->currentText(),
-            priceSpin->value(),
+            Money::fromDouble(priceSpin->value()),
             stockSpin->value(),
             currentUser->getUsername()
             );
@@ -1356,7 +1467,7 @@ void MainWindow::onRegisterProduct() {
 //     productImageLabel->setWordWrap(true);
 
 //     // Load existing image if available
-//     currentImageBase64 = product->getImageBase64();
+//     currentImageHash = product->getImageHash();
 //     if (product->hasImage()) {
 //         QImage img = product->getImage();
 //         if (!img.isNull()) {
@@ -1400,7 +1511,7 @@ void MainWindow::onRegisterProduct() {
 //         product->setCategory(catCombo->currentText());
 //         product->setPrice(priceSpin->value());
 //         product->setStock(stockSpin->value());
-//         product->setImageBase64(currentImageBase64);  // Save image (new or changed)
+//         product->setImageHash(currentImageHash);  // Save image (new or changed)
 
 //         dm->saveProducts();
 //         refreshAdminProducts();
@@ -1409,13 +1520,12 @@ void MainWindow::onRegisterProduct() {
 //     }
 // }
 void MainWindow::onEditProduct() {
-    int row = adminProductsTable->currentRow();
-    if (row < 0) {
+    int productId = selectedProductId(adminProductsTable);
+    if (productId < 0) {
         showError("Please select a product to edit");
         return;
     }
 
-    int productId = adminProductsTable->item(row, 0)->text().toInt();
     DataManager* dm = DataManager::getInstance();
     Product* product = dm->getProduct(productId);
     if (!product) {
@@ -1439,7 +1549,7 @@ void MainWindow::onEditProduct() {
     priceSpin->setRange(0.01, 100000);
     priceSpin->setPrefix("$");
     priceSpin->setDecimals(2);
-    priceSpin->setValue(product->getPrice());
+    priceSpin->setValue(product->getPrice().toDouble());
     QSpinBox* stockSpin = new QSpinBox(&dialog);
     stockSpin->setRange(0, 10000);
     stockSpin->setValue(product->getStock());
@@ -1460,16 +1570,19 @@ void MainWindow::onEditProduct() {
     productImageLabel->setWordWrap(true);
 
     // Load existing image if available
-    currentImageBase64 = product->getImageBase64();
+    currentImageHash = product->getImageHash();
     if (product->hasImage()) {
-        QImage img = product->getImage();
-        if (!img.isNull()) {
-            QPixmap pixmap = QPixmap::fromImage(img);
-            productImageLabel->setPixmap(pixmap.scaled(200, 200, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-            productImageLabel->setText("");
-        } else {
-            productImageLabel->setText("No Image");
-        }
+        QLabel* label = productImageLabel;
+        label->setText("Loading image...");
+        imageLoader->loadPixmap(product->getProductId(), currentImageHash, QSize(200, 200), label,
+                                [label](const QPixmap& pixmap) {
+            if (pixmap.isNull()) {
+                label->setText("No Image");
+            } else {
+                label->setPixmap(pixmap);
+                label->setText("");
+            }
+        });
     } else {
         productImageLabel->setText("No Image");
     }
@@ -1515,9 +1628,9 @@ void MainWindow::onEditProduct() {
         product->setName(newName);
         product->setDescription(descEdit->toPlainText());
         product->setCategory(catCombo->currentText());
-        product->setPrice(priceSpin->value());
+        product->setPrice(Money::fromDouble(priceSpin->value()));
         product->setStock(stockSpin->value());
-        product->setImageBase64(currentImageBase64);  // Save image (new or changed)
+        product->setImageHash(currentImageHash);  // Save image (new or changed)
 
         dm->saveProducts();
         refreshAdminProducts();
@@ -1527,14 +1640,14 @@ void MainWindow::onEditProduct() {
 }
 
 void MainWindow::onDeleteProduct() {
-    int row = adminProductsTable->currentRow();
-    if (row < 0) {
+    const ProductRow* selected = adminProductsModel->rowAt(adminProductsTable->currentIndex().row());
+    if (!selected) {
         showError("Please select a product to delete");
         return;
     }
 
-    int productId = adminProductsTable->item(row, 0)->text().toInt();
-    QString productName = adminProductsTable->item(row, 1)->text();
+    int productId = selected->productId;
+    QString productName = selected->name;
 
     int reply = QMessageBox::question(this, "Confirm Delete",
                                       "Are you sure you want to delete '" + productName + "'?",
@@ -1559,12 +1672,11 @@ void MainWindow::setupMyProductsTab() {
     myProductsInfoLabel = new QLabel("Products you have registered for sale:");
     layout->addWidget(myProductsInfoLabel);
 
-    myProductsTable = new QTableWidget();
-    myProductsTable->setColumnCount(6);
-    myProductsTable->setHorizontalHeaderLabels(
-        QStringList() << "ID" << "Name" << "Category" << "Price" << "Stock" << "Status");
-    myProductsTable->horizontalHeader()->setStretchLastSection(true);
-    myProductsTable->setAlternatingRowColors(true);
+    myProductsModel = new ProductTableModel({ProductTableModel::IdColumn, ProductTableModel::NameColumn,
+                                             ProductTableModel::CategoryColumn, ProductTableModel::PriceColumn,
+                                             ProductTableModel::StockColumn, ProductTableModel::StatusColumn},
+                                            this);
+    myProductsTable = createProductView(myProductsModel);
     layout->addWidget(myProductsTable);
 
     QHBoxLayout* buttonLayout = new QHBoxLayout();
@@ -1596,17 +1708,7 @@ void MainWindow::refreshMyProducts() {
         }
     }
 
-    myProductsTable->setRowCount(myProducts.size());
-
-    for (int i = 0; i < myProducts.size(); ++i) {
-        Product* p = myProducts[i];
-        myProductsTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
-        myProductsTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
-        myProductsTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        myProductsTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
-        myProductsTable->setItem(i, 4, new QTableWidgetItem(QString::number(p->getStock())));
-        myProductsTable->setItem(i, 5, new QTableWidgetItem(p->getStatusString()));
-    }
+    myProductsModel->setProducts(myProducts);
     myProductsTable->resizeColumnsToContents();
 }
 
@@ -1664,7 +1766,7 @@ void MainWindow::refreshMyProducts() {
 //     form.addRow("Product Image:", imageLayout);
 
 //     // Reset current image for new product
-//     currentImageBase64.clear();
+//     currentImageHash.clear();
 
 //     QLabel* infoLabel = new QLabel("Your product will be pending admin approval before appearing in the store.");
 //     infoLabel->setWordWrap(true);
@@ -1696,7 +1798,7 @@ void MainWindow::refreshMyProducts() {
 //             stockSpin->value(),
 //             currentUser->getUsername()
 //             );
-//         product->setImageBase64(currentImageBase64);  // Save image
+//         product->setImageHash(currentImageHash);  // Save image
 
 //         if (dm->addProduct(product)) {
 //             // Also add to customer's registered products for backward compatibility
@@ -1769,7 +1871,7 @@ void MainWindow::onRegisterNewProduct() {
     form.addRow("Product Image:", imageLayout);
 
     // Reset current image for new product
-    currentImageBase64.clear();
+    currentImageHash.clear();
 
     QLabel* infoLabel = new QLabel("Your product will be pending admin approval before appearing in the store.");
     infoLabel->setWordWrap(true);
@@ -1806,11 +1908,11 @@ void MainWindow::onRegisterNewProduct() {
             productName,
             descEdit->toPlainText(),
             catCombo->currentText(),
-            priceSpin->value(),
+            Money::fromDouble(priceSpin->value()),
             stockSpin->value(),
             currentUser->getUsername()
             );
-        product->setImageBase64(currentImageBase64);  // Save image
+        product->setImageHash(currentImageHash);  // Save image
 
         if (dm->addProduct(product)) {
             // Also add to customer's registered products for backward compatibility
@@ -1894,3 +1996,37 @@ void MainWindow::showError(const QString& message) {
 void MainWindow::showSuccess(const QString& message) {
     QMessageBox::information(this, "Success", message);
 }
+
+QTableView* MainWindow::createProductView(QAbstractItemModel* model) {
+    QTableView* view = new QTableView();
+    view->setModel(model);
+    view->horizontalHeader()->setStretchLastSection(true);
+    view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    view->setSelectionMode(QAbstractItemView::SingleSelection);
+    view->setAlternatingRowColors(true);
+    // Fixed row heights let the view lay out only the visible rows,
+    // and column sizing samples a bounded number of rows
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->horizontalHeader()->setResizeContentsPrecision(200);
+    return view;
+}
+
+const ProductRow* MainWindow::catalogRow(int productId) const {
+    for (const ProductRow& row : productsModel->products()) {
+        if (row.productId == productId)
+            return &row;
+    }
+    return nullptr;
+}
+
+int MainWindow::selectedProductId(QTableView* view) const {
+    QModelIndex index = view->currentIndex();
+    QAbstractItemModel* model = view->model();
+    if (auto* proxy = qobject_cast<QAbstractProxyModel*>(model)) {
+        index = proxy->mapToSource(index);
+        model = proxy->sourceModel();
+    }
+    ProductTableModel* products = qobject_cast<ProductTableModel*>(model);
+    if (!products) return -1;
+    return products->productIdAt(index.row());
+}
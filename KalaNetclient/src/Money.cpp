@@ -0,0 +1,128 @@
+#include "Money.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Largest unit count whose cent total, plus two decimals, fits in qint64
+constexpr qint64 kMaxUnits = (std::numeric_limits<qint64>::max() - 99) / Money::Scale;
+
+enum class Parse { Ok, Malformed, OutOfRange };
+
+template <typename Char>
+bool isAsciiDigit(Char c) {
+    return c >= Char('0') && c <= Char('9');
+}
+
+// Plain "[sign]units[.fraction]" over an already trimmed range, ASCII
+// digits only
+template <typename Char>
+Parse parseDecimal(const Char* p, const Char* end, qint64& result) {
+    bool negative = false;
+    if (p != end && (*p == Char('-') || *p == Char('+'))) {
+        negative = *p == Char('-');
+        ++p;
+    }
+
+    qint64 units = 0;
+    int digits = 0;
+    while (p != end && isAsciiDigit(*p)) {
+        units = units * 10 + (*p - Char('0'));
+        if (units > kMaxUnits)
+            return Parse::OutOfRange;
+        ++p;
+        ++digits;
+    }
+
+    qint64 cents = 0;
+    if (p != end && *p == Char('.')) {
+        ++p;
+        int fraction = 0;
+        while (p != end && isAsciiDigit(*p)) {
+            int digit = *p - Char('0');
+            if (fraction < 2)
+                cents = cents * 10 + digit;
+            else if (fraction == 2 && digit >= 5)
+                ++cents; // round half up on the third decimal
+            ++p;
+            ++fraction;
+            ++digits;
+        }
+        if (fraction == 1)
+            cents *= 10;
+    }
+
+    if (p != end || digits == 0)
+        return Parse::Malformed;
+    qint64 total = units * Money::Scale + cents;
+    result = negative ? -total : total;
+    return Parse::Ok;
+}
+
+bool inRange(double value) {
+    return std::isfinite(value) && std::fabs(value) <= double(kMaxUnits);
+}
+
+// Files written before the switch may use QString::arg(double)'s
+// exponent form, so malformed decimals get a second try as a double
+template <typename Char, typename ToDouble>
+Money parse(const Char* begin, const Char* end, ToDouble toDouble, bool* ok) {
+    qint64 cents = 0;
+    switch (parseDecimal(begin, end, cents)) {
+    case Parse::Ok:
+        if (ok) *ok = true;
+        return Money::fromCents(cents);
+    case Parse::OutOfRange:
+        if (ok) *ok = false;
+        return Money();
+    case Parse::Malformed:
+        break;
+    }
+
+    bool parsed = false;
+    double value = toDouble(&parsed);
+    parsed = parsed && inRange(value);
+    if (ok) *ok = parsed;
+    return parsed ? Money::fromDouble(value) : Money();
+}
+
+}
+
+Money Money::fromDouble(double value) {
+    return inRange(value) ? Money(qRound64(value * Scale)) : Money();
+}
+
+Money Money::fromString(QStringView text, bool* ok) {
+    text = text.trimmed();
+    return parse(text.utf16(), text.utf16() + text.size(),
+                 [text](bool* parsed) { return text.toString().toDouble(parsed); }, ok);
+}
+
+Money Money::fromUtf8(QByteArrayView text, bool* ok) {
+    return parse(text.data(), text.data() + text.size(),
+                 [text](bool* parsed) { return text.toByteArray().toDouble(parsed); }, ok);
+}
+
+QString Money::toString() const {
+    qint64 absolute = m_cents < 0 ? -m_cents : m_cents;
+    QString text = QString::number(absolute / Scale);
+    qint64 fraction = absolute % Scale;
+    text += QLatin1Char('.');
+    if (fraction < 10)
+        text += QLatin1Char('0');
+    text += QString::number(fraction);
+    if (m_cents < 0)
+        text.prepend(QLatin1Char('-'));
+    return text;
+}
+
+QDataStream& operator<<(QDataStream& stream, Money money) {
+    return stream << money.cents();
+}
+
+QDataStream& operator>>(QDataStream& stream, Money& money) {
+    qint64 cents = 0;
+    stream >> cents;
+    money = Money::fromCents(cents);
+    return stream;
+}
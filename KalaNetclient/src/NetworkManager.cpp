@@ -1,352 +1,669 @@
 #include "NetworkManager.h"
+#include "TextFormat.h"
 #include <QDataStream>
 #include <QDebug>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QThread>
 
 NetworkManager* NetworkManager::m_instance = nullptr;
+bool NetworkManager::m_threaded = true;
 
 NetworkManager* NetworkManager::instance() {
-    if (!m_instance)
+    if (!m_instance) {
         m_instance = new NetworkManager();
+        if (m_threaded) {
+            QThread* thread = new QThread();
+            thread->setObjectName("NetworkManager");
+            m_instance->moveToThread(thread);
+            thread->start();
+        }
+    }
     return m_instance;
 }
 
 void NetworkManager::destroy() {
-    delete m_instance;
+    if (!m_instance) return;
+    NetworkManager* net = m_instance;
     m_instance = nullptr;
+
+    QThread* thread = net->thread();
+    if (thread != QThread::currentThread()) {
+        // Close the socket where it lives and hand the object back, so it
+        // can be deleted here once its thread has stopped
+        QThread* target = QThread::currentThread();
+        QMetaObject::invokeMethod(net, [net, target]() {
+            net->disconnectFromServer();
+            net->moveToThread(target);
+        }, Qt::BlockingQueuedConnection);
+        thread->quit();
+        thread->wait();
+        delete thread;
+    }
+    delete net;
+}
+
+void NetworkManager::setThreaded(bool threaded) {
+    m_threaded = threaded;
 }
 
 NetworkManager::NetworkManager(QObject* parent)
     : QObject(parent)
     , m_socket(new QTcpSocket(this))
+    , m_listKind(ListKind::None)
+    , m_listExpected(-1)
+    , m_historyCursor(0)
+    , m_imageCache(new ImageCache(
+          QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/images"))
+    , m_imageExpected(0)
+    , m_port(0)
+    , m_autoReconnect(false)
+    , m_reconnectAttempt(0)
+    , m_reconnectTimer(this)
+    , m_connected(false)
 {
+    qRegisterMetaType<ProductRows>("ProductRows");
     connect(m_socket, &QTcpSocket::connected, this, &NetworkManager::onConnected);
     connect(m_socket, &QTcpSocket::disconnected, this, &NetworkManager::onDisconnected);
     connect(m_socket, &QTcpSocket::readyRead, this, &NetworkManager::onReadyRead);
     connect(m_socket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::errorOccurred),
             this, &NetworkManager::onError);
+
+    m_reconnectTimer.setSingleShot(true);
+    connect(&m_reconnectTimer, &QTimer::timeout, this, &NetworkManager::reconnect);
 }
 
 NetworkManager::~NetworkManager() {
     disconnectFromServer();
+    delete m_imageCache;
 }
 
-bool NetworkManager::connectToServer(const QString& host, quint16 port) {
-    if (m_socket->state() == QAbstractSocket::ConnectedState)
-        return true;
-
-    m_socket->connectToHost(host, port);
-    return m_socket->waitForConnected(3000);
+void NetworkManager::connectToServer(const QString& host, quint16 port) {
+    if (!onNetworkThread()) {
+        QMetaObject::invokeMethod(this, [this, host, port]() { connectToServer(host, port); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+    m_host = host;
+    m_port = port;
+    m_autoReconnect = true;
+    m_reconnectAttempt = 0;
+    m_reconnectTimer.stop();
+    if (m_socket->state() == QAbstractSocket::UnconnectedState)
+        m_socket->connectToHost(host, port);
 }
 
 void NetworkManager::disconnectFromServer() {
-    if (m_socket->state() == QAbstractSocket::ConnectedState)
-        m_socket->disconnectFromHost();
+    if (!onNetworkThread()) {
+        QMetaObject::invokeMethod(this, [this]() { disconnectFromServer(); }, Qt::QueuedConnection);
+        return;
+    }
+    m_connected = false;
+    m_autoReconnect = false;
+    m_reconnectTimer.stop();
+    m_loginUser.clear();
+    m_loginPassword.clear();
+    m_sessionUser.clear();
+    m_sessionPassword.clear();
+    m_inFlight.clear();
+    if (m_socket->state() != QAbstractSocket::UnconnectedState)
+        m_socket->abort();
+    resetResponseState();
+}
+
+void NetworkManager::send(const QByteArray& request, Retry retry) {
+    // Requests are made on the GUI thread; the socket is only touched here
+    if (!onNetworkThread()) {
+        QMetaObject::invokeMethod(this, [this, request, retry]() { send(request, retry); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+    if (m_socket->state() == QAbstractSocket::ConnectedState) {
+        m_inFlight.enqueue({request, retry, false});
+        m_socket->write(request);
+        return;
+    }
+    // While reconnecting, safe requests wait and go out with the replay
+    if (m_autoReconnect && retry == Retry::Replay) {
+        m_inFlight.enqueue({request, retry, false});
+        return;
+    }
+    emit error("Not connected to server");
+}
+
+void NetworkManager::completeRequest() {
+    if (!m_inFlight.isEmpty())
+        m_inFlight.dequeue();
+}
+
+void NetworkManager::resetResponseState() {
+    m_buffer.clear();
+    m_listKind = ListKind::None;
+    m_listExpected = -1;
+    m_rows = ProductRows();
+    m_history = QVector<Transaction>();
+    m_cart.clear();
+    m_imageExpected = 0;
+}
+
+void NetworkManager::scheduleReconnect() {
+    if (!m_autoReconnect || m_reconnectTimer.isActive())
+        return;
+    // 0.5s doubling up to 30s, with +-20% jitter so clients don't return in step
+    int base = qMin(500 << qMin(m_reconnectAttempt, 6), 30000);
+    int delay = base + QRandomGenerator::global()->bounded(base * 2 / 5 + 1) - base / 5;
+    ++m_reconnectAttempt;
+    m_reconnectTimer.start(delay);
+    emit reconnecting(m_reconnectAttempt, delay);
+}
+
+void NetworkManager::reconnect() {
+    if (m_autoReconnect && m_socket->state() == QAbstractSocket::UnconnectedState)
+        m_socket->connectToHost(m_host, m_port);
+}
+
+bool NetworkManager::isConnected() const {
+    return m_connected;
+}
+
+bool NetworkManager::onNetworkThread() const {
+    return QThread::currentThread() == thread();
 }
 
 void NetworkManager::login(const QString& username, const QString& password) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
+    if (!onNetworkThread()) {
+        QMetaObject::invokeMethod(this, [this, username, password]() { login(username, password); },
+                                  Qt::QueuedConnection);
         return;
     }
+    // Kept so a dropped connection can log in again on its own
+    m_loginUser = username;
+    m_loginPassword = password;
     QString cmd = QString("LOGIN %1 %2\n").arg(username, password);
-    m_socket->write(cmd.toUtf8());
+    send(cmd.toUtf8(), Retry::Drop);
 }
 
 void NetworkManager::signup(const QString& username, const QString& password,
                             const QString& email, const QString& phone,
                             const QString& address, UserType type)
 {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
     QString typeStr = (type == UserType::ADMIN) ? "admin" : "customer";
     QString cmd = QString("SIGNUP %1 %2 %3 %4 %5 %6\n")
                       .arg(username, password, email, phone, address, typeStr);
-    m_socket->write(cmd.toUtf8());
+    send(cmd.toUtf8(), Retry::Drop);
 }
 
-void NetworkManager::getApprovedProducts() {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write("GET_APPROVED_PRODUCTS\n");
+void NetworkManager::getApprovedProducts(const QString& knownVersion) {
+    if (knownVersion.isEmpty())
+        send("GET_APPROVED_PRODUCTS\n", Retry::Replay);
+    else
+        send(QString("GET_APPROVED_PRODUCTS %1\n").arg(knownVersion).toUtf8(), Retry::Replay);
 }
 
 void NetworkManager::getPendingProducts() {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write("GET_PENDING_PRODUCTS\n");
+    send("GET_PENDING_PRODUCTS\n", Retry::Replay);
 }
 
 void NetworkManager::getProductDetails(int productId) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("GET_PRODUCT %1\n").arg(productId).toUtf8());
+    send(QString("GET_PRODUCT %1\n").arg(productId).toUtf8(), Retry::Replay);
 }
 
 void NetworkManager::addProduct(const QString& name, const QString& description,
-                                const QString& category, double price, int stock,
-                                const QString& seller)
+                                const QString& category, Money price, int stock,
+                                const QString& seller, const QString& imageHash)
 {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    QString cmd = QString("ADD_PRODUCT %1|%2|%3|%4|%5|%6\n")
+    QString cmd = QString("ADD_PRODUCT %1|%2|%3|%4|%5|%6")
                       .arg(name, description, category)
-                      .arg(price).arg(stock).arg(seller);
-    m_socket->write(cmd.toUtf8());
+                      .arg(price.toString()).arg(stock).arg(seller);
+    if (!imageHash.isEmpty())
+        cmd += "|" + imageHash;
+    send((cmd + "\n").toUtf8(), Retry::Drop);
 }
 
 void NetworkManager::approveProduct(int productId) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("APPROVE %1\n").arg(productId).toUtf8());
+    send(QString("APPROVE %1\n").arg(productId).toUtf8(), Retry::Drop);
 }
 
 void NetworkManager::rejectProduct(int productId) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("REJECT %1\n").arg(productId).toUtf8());
+    send(QString("REJECT %1\n").arg(productId).toUtf8(), Retry::Drop);
 }
 
 void NetworkManager::addToCart(const QString& username, int productId, int quantity) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("ADD_TO_CART %1 %2 %3\n")
-                        .arg(username).arg(productId).arg(quantity).toUtf8());
+    send(QString("ADD_TO_CART %1 %2 %3\n")
+             .arg(username).arg(productId).arg(quantity).toUtf8(), Retry::Drop);
 }
 
 void NetworkManager::getCart(const QString& username) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("GET_CART %1\n").arg(username).toUtf8());
+    send(QString("GET_CART %1\n").arg(username).toUtf8(), Retry::Replay);
 }
 
 void NetworkManager::removeFromCart(const QString& username, int productId) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("REMOVE_FROM_CART %1 %2\n")
-                        .arg(username).arg(productId).toUtf8());
+    send(QString("REMOVE_FROM_CART %1 %2\n")
+             .arg(username).arg(productId).toUtf8(), Retry::Replay);
 }
 
 void NetworkManager::clearCart(const QString& username) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
+    send(QString("CLEAR_CART %1\n").arg(username).toUtf8(), Retry::Replay);
+}
+
+void NetworkManager::cartBatch(const QString& username, const QVector<CartOp>& ops) {
+    if (ops.isEmpty()) return;
+    // Set and remove land on the same cart when repeated; add does not
+    Retry retry = Retry::Replay;
+    QString cmd = "CART_BATCH " + username;
+    for (const CartOp& op : ops) {
+        switch (op.kind) {
+        case CartOp::Add:
+            cmd += QString(" add:%1:%2").arg(op.productId).arg(op.quantity);
+            retry = Retry::Drop;
+            break;
+        case CartOp::Set:
+            cmd += QString(" set:%1:%2").arg(op.productId).arg(op.quantity);
+            break;
+        case CartOp::Remove:
+            cmd += QString(" remove:%1").arg(op.productId);
+            break;
+        }
     }
-    m_socket->write(QString("CLEAR_CART %1\n").arg(username).toUtf8());
+    send((cmd + "\n").toUtf8(), retry);
 }
 
 void NetworkManager::checkout(const QString& username) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("CHECKOUT %1\n").arg(username).toUtf8());
+    send(QString("CHECKOUT %1\n").arg(username).toUtf8(), Retry::Drop);
 }
 
 void NetworkManager::getMyProducts(const QString& username) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("GET_MY_PRODUCTS %1\n").arg(username).toUtf8());
+    send(QString("GET_MY_PRODUCTS %1\n").arg(username).toUtf8(), Retry::Replay);
 }
 
 void NetworkManager::getWallet(const QString& username) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
-    m_socket->write(QString("GET_WALLET %1\n").arg(username).toUtf8());
+    send(QString("GET_WALLET %1\n").arg(username).toUtf8(), Retry::Replay);
+}
+
+void NetworkManager::deposit(const QString& username, Money amount) {
+    send(QString("DEPOSIT %1 %2\n").arg(username, amount.toString()).toUtf8(), Retry::Drop);
+}
+
+void NetworkManager::getHistory(const QString& username, HistoryRole role,
+                                const QDate& from, const QDate& to,
+                                int cursor, int limit)
+{
+    QString cmd = QString("GET_HISTORY %1 limit=%2").arg(username).arg(limit);
+    if (role == HistoryRole::Buyer)
+        cmd += " role=buyer";
+    else if (role == HistoryRole::Seller)
+        cmd += " role=seller";
+    if (from.isValid())
+        cmd += " from=" + from.toString(Qt::ISODate);
+    if (to.isValid())
+        cmd += " to=" + to.toString(Qt::ISODate);
+    if (cursor >= 0)
+        cmd += QString(" cursor=%1").arg(cursor);
+    send((cmd + "\n").toUtf8(), Retry::Replay);
 }
 
-void NetworkManager::deposit(const QString& username, double amount) {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
+void NetworkManager::getImage(const QString& hash, const QString& size) {
+    // The disk cache is read on the network thread too
+    if (!onNetworkThread()) {
+        QMetaObject::invokeMethod(this, [this, hash, size]() { getImage(hash, size); },
+                                  Qt::QueuedConnection);
         return;
     }
-    m_socket->write(QString("DEPOSIT %1 %2\n").arg(username).arg(amount).toUtf8());
+    QString key = hash + "." + size;
+    QByteArray cached = m_imageCache->get(hash, size);
+    if (!cached.isEmpty()) {
+        emit imageReceived(hash, size, cached);
+        if (m_validatedImages.contains(key))
+            return;
+    }
+
+    // Offline, the cached copy will do until the next request
+    if (m_socket->state() != QAbstractSocket::ConnectedState && !cached.isEmpty())
+        return;
+    // A cached copy is only re-sent by the server if its etag changed
+    m_validatedImages.insert(key);
+    QString cmd = QString("GET_IMAGE %1 %2").arg(hash, size);
+    if (!cached.isEmpty())
+        cmd += " " + ImageCache::etagOf(cached);
+    send((cmd + "\n").toUtf8(), Retry::Replay);
+}
+
+void NetworkManager::uploadImage(const QByteArray& data) {
+    // Blobs are content-addressed, so uploading twice is harmless
+    send(QString("PUT_IMAGE %1\n").arg(data.size()).toUtf8() + data, Retry::Replay);
 }
 
 void NetworkManager::updateProfile(const QString& username, const QString& email,
                                    const QString& phone, const QString& address)
 {
-    if (m_socket->state() != QAbstractSocket::ConnectedState) {
-        emit error("Not connected to server");
-        return;
-    }
     QString cmd = QString("UPDATE_PROFILE %1|%2|%3|%4\n")
                       .arg(username, email, phone, address);
-    m_socket->write(cmd.toUtf8());
+    send(cmd.toUtf8(), Retry::Replay);
 }
 
 void NetworkManager::onConnected() {
+    m_connected = true;
+    m_reconnectAttempt = 0;
+    QQueue<PendingRequest> replay;
+    replay.swap(m_inFlight);
+
+    // Log the session back in before anything that depends on it
+    if (!m_sessionUser.isEmpty()) {
+        QByteArray resume = QString("LOGIN %1 %2\n").arg(m_sessionUser, m_sessionPassword).toUtf8();
+        m_inFlight.enqueue({resume, Retry::Drop, true});
+        m_socket->write(resume);
+    }
+    for (const PendingRequest& request : replay) {
+        m_inFlight.enqueue(request);
+        m_socket->write(request.data);
+    }
     emit connected();
 }
 
 void NetworkManager::onDisconnected() {
+    m_connected = false;
+    // A partial response is useless; answered or not, only requests that
+    // are safe to repeat survive for the replay
+    resetResponseState();
+    QQueue<PendingRequest> pending;
+    pending.swap(m_inFlight);
+    for (const PendingRequest& request : pending) {
+        if (request.resume)
+            continue;
+        if (request.retry == Retry::Replay && m_autoReconnect)
+            m_inFlight.enqueue(request);
+        else
+            emit error("Connection lost before the server answered: "
+                       + QString::fromUtf8(request.data.left(request.data.indexOf(' '))).trimmed());
+    }
     emit disconnected();
+    scheduleReconnect();
 }
 
 void NetworkManager::onError(QAbstractSocket::SocketError) {
-    emit error(m_socket->errorString());
+    // Report the first failure of an outage, not every retry
+    if (m_reconnectAttempt == 0)
+        emit error(m_socket->errorString());
+    // A failed connect never reaches onDisconnected()
+    if (m_socket->state() != QAbstractSocket::ConnectedState)
+        scheduleReconnect();
 }
 
 void NetworkManager::onReadyRead() {
     m_buffer += m_socket->readAll();
 
-    while (m_buffer.contains('\n')) {
-        int pos = m_buffer.indexOf('\n');
-        QString line = m_buffer.left(pos).trimmed();
-        m_buffer = m_buffer.mid(pos + 1);
+    // Walk the raw bytes by offset and drop the consumed prefix once, so a
+    // large list costs one pass and rows are never decoded as a whole line
+    qsizetype start = 0;
+    while (start < m_buffer.size()) {
+        if (m_imageExpected > 0) {
+            // Raw image payload; wait until all of it has arrived
+            if (m_buffer.size() - start < m_imageExpected) break;
+            QByteArray payload = m_buffer.mid(start, m_imageExpected);
+            start += m_imageExpected;
+            m_imageExpected = 0;
+            finishImage(payload);
+            continue;
+        }
+
+        qsizetype end = m_buffer.indexOf('\n', start);
+        if (end == -1) break;
+        QByteArrayView line = QByteArrayView(m_buffer).sliced(start, end - start);
+        start = end + 1;
+        if (line.endsWith('\r'))
+            line = line.chopped(1);
 
         if (line.isEmpty())
             continue;
 
-        if (line.startsWith("OK ")) {
-            QString data = line.mid(3);
-
-            if (data.startsWith("LOGIN ")) {
-                QStringList parts = data.mid(6).split('|');
-                if (parts.size() >= 3) {
-                    QString username = parts[0];
-                    double wallet = parts[1].toDouble();
-                    QString type = parts[2];
-                    User* user = nullptr;
-                    if (type == "Admin")
-                        user = new Admin(username, "", "", "", "");
-                    else
-                        user = new Customer(username, "", "", "", "");
-                    user->setWalletBalance(wallet);
-                    emit loginResult(true, user, "");
-                } else {
-                    emit loginResult(false, nullptr, "Invalid login data");
-                }
-            }
-            else if (data.startsWith("SIGNUP")) {
-                emit signupResult(true, "");
-            }
-            else if (data.startsWith("APPROVED_PRODUCTS")) {
-                QVector<Product*> products;
-                QStringList lines = data.split('\n');
-                // Skip the first line (header) and parse subsequent lines
-                for (int i = 1; i < lines.size(); ++i) {
-                    QStringList fields = lines[i].split('|');
-                    if (fields.size() >= 7) {
-                        Product* p = new Product();
-                        p->setProductId(fields[0].toInt());
-                        p->setName(fields[1]);
-                        p->setCategory(fields[2]);
-                        p->setPrice(fields[3].toDouble());
-                        p->setStock(fields[4].toInt());
-                        p->setSellerUsername(fields[5]);
-                        p->setStatus(fields[6] == "Approved" ? ProductStatus::APPROVED
-                                                             : ProductStatus::PENDING_APPROVAL);
-                        products.append(p);
-                    }
-                }
-                emit approvedProductsReceived(products);
+        if (m_listKind != ListKind::None) {
+            // With a count every line up to it is a row; without one a new
+            // response line ends the list
+            bool isResponse = line.startsWith("OK ") || line.startsWith("ERROR ");
+            if (m_listExpected >= 0 || !isResponse) {
+                appendRow(line);
+                continue;
             }
-            else if (data.startsWith("PENDING_PRODUCTS")) {
-                QVector<Product*> products;
-                QStringList lines = data.split('\n');
-                for (int i = 1; i < lines.size(); ++i) {
-                    QStringList fields = lines[i].split('|');
-                    if (fields.size() >= 7) {
-                        Product* p = new Product();
-                        p->setProductId(fields[0].toInt());
-                        p->setName(fields[1]);
-                        p->setCategory(fields[2]);
-                        p->setPrice(fields[3].toDouble());
-                        p->setStock(fields[4].toInt());
-                        p->setSellerUsername(fields[5]);
-                        p->setStatus(ProductStatus::PENDING_APPROVAL);
-                        products.append(p);
-                    }
-                }
-                emit pendingProductsReceived(products);
-            }
-            else if (data.startsWith("ADD_PRODUCT")) {
-                emit addProductResult(true, "");
-            }
-            else if (data.startsWith("APPROVE")) {
-                emit approveResult(true, "");
-            }
-            else if (data.startsWith("CART")) {
-                QMap<int, int> cart;
-                double total = 0;
-                QStringList lines = data.split('\n');
-                for (const QString& l : lines) {
-                    if (l.startsWith("TOTAL|")) {
-                        total = l.mid(6).toDouble();
-                    } else {
-                        QStringList fields = l.split('|');
-                        if (fields.size() >= 4) {
-                            cart[fields[0].toInt()] = fields[3].toInt();
-                        }
-                    }
-                }
-                emit cartReceived(cart, total);
-            }
-            else if (data.startsWith("CHECKOUT ")) {
-                double total = data.mid(9).toDouble();
-                emit checkoutResult(true, total, "");
-            }
-            else if (data.startsWith("MY_PRODUCTS")) {
-                QVector<Product*> products;
-                QStringList lines = data.split('\n');
-                for (int i = 1; i < lines.size(); ++i) {
-                    QStringList fields = lines[i].split('|');
-                    if (fields.size() >= 7) {
-                        Product* p = new Product();
-                        p->setProductId(fields[0].toInt());
-                        p->setName(fields[1]);
-                        p->setCategory(fields[2]);
-                        p->setPrice(fields[3].toDouble());
-                        p->setStock(fields[4].toInt());
-                        p->setStatus(fields[5] == "Approved" ? ProductStatus::APPROVED :
-                                     (fields[5] == "Pending Approval" ? ProductStatus::PENDING_APPROVAL
-                                                                      : ProductStatus::SOLD));
-                        p->setSellerUsername(fields[6]);
-                        products.append(p);
-                    }
+            finishList();
+        }
+        handleLine(QString::fromUtf8(line).trimmed());
+
+        // Lists and images complete their request once the rest arrives
+        if (m_listKind != ListKind::None) {
+            if (m_listExpected == 0)
+                finishList();
+        } else if (m_imageExpected == 0) {
+            completeRequest();
+        }
+    }
+    m_buffer.remove(0, start);
+
+    // Countless lists end when the server has nothing more queued for us
+    if (m_listKind != ListKind::None && m_listExpected < 0
+        && m_buffer.isEmpty() && m_socket->bytesAvailable() == 0)
+        finishList();
+}
+
+void NetworkManager::finishImage(const QByteArray& data) {
+    completeRequest();
+    m_imageCache->put(m_imageHash, m_imageSize, data);
+    emit imageReceived(m_imageHash, m_imageSize, data);
+}
+
+void NetworkManager::beginList(ListKind kind, const QString& header) {
+    m_listKind = kind;
+    m_rows = ProductRows();
+    m_history = QVector<Transaction>();
+    m_cart.clear();
+    m_cartTotal = Money();
+    m_historyCursor = header.section(' ', 2, 2).toInt();
+    m_catalogVersion = kind == ListKind::Approved ? header.section(' ', 2, 2) : QString();
+
+    bool ok = false;
+    int count = header.section(' ', 1, 1).toInt(&ok);
+    m_listExpected = ok ? count : -1;
+    if (m_listExpected > 0) {
+        if (kind == ListKind::History)
+            m_history.reserve(m_listExpected);
+        else if (kind != ListKind::Cart)
+            m_rows.reserve(m_listExpected);
+    }
+}
+
+void NetworkManager::appendRow(QByteArrayView line) {
+    FieldReader fields(line);
+    if (m_listKind == ListKind::History) {
+        if (fields.count() >= 7) {
+            Transaction trans;
+            trans.productId = fields.nextInt();
+            trans.productName = fields.nextString();
+            trans.sellerUsername = fields.nextString();
+            trans.buyerUsername = fields.nextString();
+            trans.quantity = fields.nextInt();
+            trans.totalPrice = fields.nextMoney();
+            trans.date = QDateTime::fromString(fields.nextString(), "yyyy-MM-dd hh:mm:ss");
+            m_history.append(trans);
+        }
+    }
+    else if (m_listKind == ListKind::Cart) {
+        // productId|name|price|quantity, then TOTAL|amount
+        if (fields.count() == 2 && fields.next() == "TOTAL")
+            m_cartTotal = fields.nextMoney();
+        else if (fields.count() >= 4) {
+            int productId = fields.nextInt();
+            fields.next();
+            fields.next();
+            m_cart[productId] = fields.nextInt();
+        }
+    }
+    else if (fields.count() >= 7) {
+        ProductRow row;
+        row.productId = fields.nextInt();
+        row.name = fields.nextString();
+        row.category = fields.nextString();
+        row.price = fields.nextMoney();
+        row.stock = fields.nextInt();
+
+        // MY_PRODUCTS sends status before seller
+        QByteArrayView status;
+        if (m_listKind == ListKind::Mine) {
+            status = fields.next();
+            row.sellerUsername = fields.nextString();
+        } else {
+            row.sellerUsername = fields.nextString();
+            status = fields.next();
+        }
+        if (status == "Approved")
+            row.status = ProductStatus::APPROVED;
+        else if (status == "Sold")
+            row.status = ProductStatus::SOLD;
+        else
+            row.status = ProductStatus::PENDING_APPROVAL;
+        row.imageHash = fields.nextString();
+
+        m_rows.append(row);
+    }
+
+    if (m_listExpected >= 0 && --m_listExpected == 0)
+        finishList();
+}
+
+void NetworkManager::finishList() {
+    ListKind kind = m_listKind;
+    ProductRows rows = m_rows;
+    QVector<Transaction> history = m_history;
+    QMap<int, int> cart = m_cart;
+    m_listKind = ListKind::None;
+    m_listExpected = -1;
+    m_rows = ProductRows();
+    m_history = QVector<Transaction>();
+    m_cart.clear();
+    completeRequest();
+
+    switch (kind) {
+    case ListKind::Approved:
+        emit approvedProductsReceived(rows, m_catalogVersion);
+        break;
+    case ListKind::Pending:
+        emit pendingProductsReceived(rows);
+        break;
+    case ListKind::Mine:
+        emit myProductsReceived(rows);
+        break;
+    case ListKind::History:
+        emit historyReceived(history, m_historyCursor);
+        break;
+    case ListKind::Cart:
+        emit cartReceived(cart, m_cartTotal);
+        break;
+    case ListKind::None:
+        break;
+    }
+}
+
+bool NetworkManager::resuming() const {
+    return !m_inFlight.isEmpty() && m_inFlight.head().resume;
+}
+
+void NetworkManager::handleLine(const QString& line) {
+    if (line.startsWith("OK ")) {
+        QString data = line.mid(3);
+
+        if (data.startsWith("LOGIN ")) {
+            QStringList parts = data.mid(6).split('|');
+            if (parts.size() >= 3) {
+                QString username = parts[0];
+                Money wallet = Money::fromString(parts[1]);
+                QString type = parts[2];
+                User* user = nullptr;
+                if (type == "Admin")
+                    user = new Admin(username, "", "", "", "");
+                else
+                    user = new Customer(username, "", "", "", "");
+                user->setWalletBalance(wallet);
+                if (resuming()) {
+                    delete user;
+                    emit sessionResumed();
+                } else {
+                    m_sessionUser = m_loginUser;
+                    m_sessionPassword = m_loginPassword;
+                    emit loginResult(true, user, "");
                 }
-                emit myProductsReceived(products);
-            }
-            else if (data.startsWith("WALLET ")) {
-                double balance = data.mid(7).toDouble();
-                emit walletReceived(balance);
+            } else {
+                emit loginResult(false, nullptr, "Invalid login data");
             }
-            else if (data.startsWith("DEPOSIT ")) {
-                double balance = data.mid(8).toDouble();
-                emit depositResult(true, balance, "");
+        }
+        else if (data.startsWith("SIGNUP")) {
+            emit signupResult(true, "");
+        }
+        else if (data.startsWith("APPROVED_PRODUCTS_NOT_MODIFIED")) {
+            emit approvedProductsNotModified(data.section(' ', 1, 1));
+        }
+        else if (data.startsWith("APPROVED_PRODUCTS")) {
+            beginList(ListKind::Approved, data);
+        }
+        else if (data.startsWith("PENDING_PRODUCTS")) {
+            beginList(ListKind::Pending, data);
+        }
+        else if (data.startsWith("ADD_PRODUCT")) {
+            emit addProductResult(true, "");
+        }
+        else if (data.startsWith("APPROVE")) {
+            emit approveResult(true, "");
+        }
+        else if (data.startsWith("CART")) {
+            // CART and CART_BATCH both answer with the whole cart
+            beginList(ListKind::Cart, data);
+        }
+        else if (data.startsWith("CHECKOUT ")) {
+            Money total = Money::fromString(QStringView(data).mid(9));
+            emit checkoutResult(true, total, "");
+        }
+        else if (data.startsWith("MY_PRODUCTS")) {
+            beginList(ListKind::Mine, data);
+        }
+        else if (data.startsWith("IMAGE ")) {
+            // IMAGE <hash> <size> <etag> <length>, then <length> raw bytes
+            QStringList parts = data.split(' ');
+            if (parts.size() >= 5) {
+                m_imageHash = parts[1];
+                m_imageSize = parts[2];
+                m_imageExpected = parts[4].toLongLong();
+                if (m_imageExpected <= 0)
+                    m_imageExpected = 0;
             }
-            // Add other response types as needed
         }
-        else if (line.startsWith("ERROR ")) {
-            QString errorMsg = line.mid(6);
-            emit error(errorMsg);
+        else if (data.startsWith("IMAGE_NOT_MODIFIED ")) {
+            // The cached copy getImage() already emitted is current
+        }
+        else if (data.startsWith("PUT_IMAGE ")) {
+            emit imageUploaded(data.mid(10).trimmed());
+        }
+        else if (data.startsWith("HISTORY ")) {
+            beginList(ListKind::History, data);
+        }
+        else if (data.startsWith("WALLET ")) {
+            Money balance = Money::fromString(QStringView(data).mid(7));
+            emit walletReceived(balance);
         }
-        else {
-            qDebug() << "Unhandled response:" << line;
+        else if (data.startsWith("DEPOSIT ")) {
+            Money balance = Money::fromString(QStringView(data).mid(8));
+            emit depositResult(true, balance, "");
         }
+        // Add other response types as needed
     }
-}
\ No newline at end of file
+    else if (line.startsWith("ERROR ")) {
+        QString errorMsg = line.mid(6);
+        if (resuming()) {
+            // Credentials changed while we were away; log in again by hand
+            m_sessionUser.clear();
+            m_sessionPassword.clear();
+            emit error("Session could not be resumed: " + errorMsg);
+            return;
+        }
+        emit error(errorMsg);
+    }
+    else {
+        qDebug() << "Unhandled response:" << line;
+    }
+}
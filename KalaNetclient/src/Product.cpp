@@ -1,16 +1,19 @@
 #include "Product.h"
+#include "ImageStore.h"
 #include <QBuffer>
 #include <QImageReader>
 #include <QImageWriter>
 
+ImageStore* Product::imageStore = nullptr;
+
 Product::Product()
-    : productId(0), price(0.0), stock(0),
+    : productId(0), price(), stock(0),
     status(ProductStatus::PENDING_APPROVAL) {
     registrationDate = QDateTime::currentDateTime();
 }
 
 Product::Product(int id, const QString& name, const QString& description,
-                 const QString& category, double price, int stock,
+                 const QString& category, Money price, int stock,
                  const QString& seller)
     : productId(id), name(name), description(description),
     category(category), price(price), stock(stock),
@@ -18,7 +21,7 @@ Product::Product(int id, const QString& name, const QString& description,
     registrationDate = QDateTime::currentDateTime();
 }
 
-QString Product::getStatusString() const {
+QString Product::statusString(ProductStatus status) {
     switch(status) {
     case ProductStatus::PENDING_APPROVAL:
         return "Pending Approval";
@@ -44,16 +47,16 @@ bool Product::purchase(int quantity) {
 
 // Image handling implementation
 QImage Product::getImage() const {
-    return base64ToImage(imageBase64);
+    return loadImage(imageHash);
 }
 
 void Product::setImage(const QImage& image) {
-    imageBase64 = imageToBase64(image);
+    imageHash = storeImage(image);
 }
 
-QString Product::imageToBase64(const QImage& image, int maxWidth, int maxHeight) {
+QByteArray Product::encodeImage(const QImage& image, int maxWidth, int maxHeight) {
     if (image.isNull()) {
-        return QString();
+        return QByteArray();
     }
 
     // Resize if too large
@@ -66,19 +69,30 @@ QString Product::imageToBase64(const QImage& image, int maxWidth, int maxHeight)
 
     // Use JPEG for smaller size (85% quality for good balance)
     resized.save(&buffer, "JPEG", 85);
+    return byteArray;
+}
+
+QString Product::storeImage(const QImage& image, int maxWidth, int maxHeight) {
+    if (!imageStore) {
+        return QString();
+    }
+    return imageStore->put(encodeImage(image, maxWidth, maxHeight));
+}
 
-    // Convert to base64
-    return QString::fromLatin1(byteArray.toBase64());
+QByteArray Product::loadImageData(const QString& hash) {
+    if (hash.isEmpty() || !imageStore) {
+        return QByteArray();
+    }
+    return imageStore->get(hash);
 }
 
-QImage Product::base64ToImage(const QString& base64) {
-    if (base64.isEmpty()) {
+QImage Product::loadImage(const QString& hash) {
+    if (hash.isEmpty() || !imageStore) {
         return QImage();
     }
 
-    QByteArray byteArray = QByteArray::fromBase64(base64.toLatin1());
     QImage image;
-    image.loadFromData(byteArray);
+    image.loadFromData(imageStore->get(hash));
     return image;
 }
 
@@ -102,13 +116,13 @@ QImage Product::resizeImage(const QImage& source, int maxWidth, int maxHeight) {
 void Product::saveToStream(QDataStream& stream) const {
     stream << productId << name << description << category
            << price << stock << sellerUsername
-           << static_cast<int>(status) << registrationDate << imagePath << imageBase64;
+           << static_cast<int>(status) << registrationDate << imagePath << imageHash;
 }
 
 void Product::loadFromStream(QDataStream& stream) {
     int statusInt;
     stream >> productId >> name >> description >> category
         >> price >> stock >> sellerUsername
-        >> statusInt >> registrationDate >> imagePath >> imageBase64;
+        >> statusInt >> registrationDate >> imagePath >> imageHash;
     status = static_cast<ProductStatus>(statusInt);
 }
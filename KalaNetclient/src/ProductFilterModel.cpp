@@ -0,0 +1,154 @@
+#include "ProductFilterModel.h"
+#include "ProductTableModel.h"
+#include <QPromise>
+#include <QtConcurrent>
+
+namespace {
+
+bool matches(const ProductRow& row, const QString& text, const QString& category) {
+    if (!category.isEmpty() && row.category != category)
+        return false;
+    if (text.isEmpty())
+        return true;
+    return row.name.contains(text, Qt::CaseInsensitive)
+           || row.description.contains(text, Qt::CaseInsensitive)
+           || row.category.contains(text, Qt::CaseInsensitive);
+}
+
+}
+
+ProductFilterModel::ProductFilterModel(ProductTableModel* source, QObject* parent)
+    : QSortFilterProxyModel(parent), m_source(source), m_serial(0), m_generation(0),
+      m_active(false), m_appliedGeneration(-1), m_runningGeneration(-1), m_runningSerial(-1) {
+    setSourceModel(source);
+    setSortRole(ProductTableModel::SortRole);
+
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(150);
+    connect(&m_debounce, &QTimer::timeout, this, &ProductFilterModel::start);
+    connect(&m_watcher, &QFutureWatcherBase::finished, this, &ProductFilterModel::finished);
+
+    // Matched source rows go stale with any change; the id set stays usable
+    // until the refreshed result arrives
+    connect(source, &QAbstractItemModel::modelReset, this, &ProductFilterModel::sourceChanged);
+    connect(source, &QAbstractItemModel::rowsInserted, this, &ProductFilterModel::sourceChanged);
+    connect(source, &QAbstractItemModel::rowsRemoved, this, &ProductFilterModel::sourceChanged);
+    connect(source, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex&, const QModelIndex&, const QList<int>& roles) {
+        // A thumbnail arriving changes nothing the filter matches on
+        if (roles.size() == 1 && roles.first() == Qt::DecorationRole) return;
+        sourceChanged();
+    });
+}
+
+ProductFilterModel::~ProductFilterModel() {
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+void ProductFilterModel::setSearchText(const QString& text) {
+    QString trimmed = text.trimmed();
+    if (trimmed == m_text) return;
+    m_text = trimmed;
+    ++m_serial;
+    m_debounce.start();
+}
+
+void ProductFilterModel::setCategory(const QString& category) {
+    if (category == m_category) return;
+    m_category = category;
+    ++m_serial;
+    m_debounce.start();
+}
+
+void ProductFilterModel::applyNow() {
+    m_debounce.stop();
+    start();
+}
+
+void ProductFilterModel::sourceChanged() {
+    ++m_generation;
+    if (!m_active && !m_watcher.isRunning()) return;
+    ++m_serial;
+    m_debounce.start();
+}
+
+void ProductFilterModel::start() {
+    if (m_text.isEmpty() && m_category.isEmpty()) {
+        // No filter: nothing to compute
+        m_watcher.cancel();
+        m_runningSerial = -1;
+        m_applied = Result();
+        m_appliedText.clear();
+        m_appliedCategory.clear();
+        if (m_active) {
+            m_active = false;
+            invalidateFilter();
+        }
+        emit filterApplied(rowCount());
+        return;
+    }
+
+    // Already computing exactly this query
+    if (m_watcher.isRunning() && m_runningText == m_text && m_runningCategory == m_category
+        && m_runningGeneration == m_generation) {
+        m_runningSerial = m_serial;
+        return;
+    }
+
+    // Narrowing: same source rows and category, text only grew
+    bool narrowing = m_active && m_appliedGeneration == m_generation
+                     && m_appliedCategory == m_category
+                     && m_text.startsWith(m_appliedText, Qt::CaseInsensitive);
+    QVector<int> candidates;
+    if (narrowing)
+        candidates = m_applied.rows;
+
+    m_watcher.cancel();
+    m_runningText = m_text;
+    m_runningCategory = m_category;
+    m_runningGeneration = m_generation;
+    m_runningSerial = m_serial;
+
+    ProductRows rows = m_source->products();
+    QString text = m_text;
+    QString category = m_category;
+    m_watcher.setFuture(QtConcurrent::run(
+        [rows, candidates, narrowing, text, category](QPromise<Result>& promise) {
+            Result result;
+            int total = narrowing ? int(candidates.size()) : int(rows.size());
+            for (int i = 0; i < total; ++i) {
+                if ((i & 4095) == 0 && promise.isCanceled())
+                    return;
+                int row = narrowing ? candidates[i] : i;
+                const ProductRow& product = rows[row];
+                if (matches(product, text, category)) {
+                    result.rows.append(row);
+                    result.ids.insert(product.productId);
+                }
+            }
+            promise.addResult(result);
+        }));
+}
+
+void ProductFilterModel::finished() {
+    if (m_watcher.isCanceled() || m_watcher.future().resultCount() == 0)
+        return;
+    // A newer query or source change is already waiting on the debounce
+    if (m_runningSerial != m_serial)
+        return;
+
+    m_applied = m_watcher.result();
+    m_appliedText = m_runningText;
+    m_appliedCategory = m_runningCategory;
+    m_appliedGeneration = m_runningGeneration;
+    m_active = true;
+    invalidateFilter();
+    emit filterApplied(rowCount());
+}
+
+bool ProductFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    Q_UNUSED(sourceParent)
+    if (!m_active) return true;
+    return m_applied.ids.contains(m_source->productIdAt(sourceRow));
+}
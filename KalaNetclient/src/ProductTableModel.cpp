@@ -0,0 +1,232 @@
+#include "ProductTableModel.h"
+#include "Product.h"
+#include <QSet>
+
+namespace {
+
+bool sameRow(const ProductRow& a, const ProductRow& b) {
+    return a.productId == b.productId
+           && a.name == b.name
+           && a.category == b.category
+           && a.price == b.price
+           && a.stock == b.stock
+           && a.sellerUsername == b.sellerUsername
+           && a.status == b.status
+           && a.imageHash == b.imageHash
+           && a.description == b.description
+           && a.registrationDate == b.registrationDate;
+}
+
+}
+
+ProductTableModel::ProductTableModel(const QVector<Column>& columns, QObject* parent)
+    : QAbstractTableModel(parent), m_columns(columns), m_showThumbnails(false),
+      m_thumbnails(2000) {
+}
+
+int ProductTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : int(m_rows.size());
+}
+
+int ProductTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : int(m_columns.size());
+}
+
+QVariant ProductTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_rows.size() || index.column() >= m_columns.size())
+        return QVariant();
+    const ProductRow& row = m_rows[index.row()];
+    Column column = m_columns[index.column()];
+    if (role == Qt::DisplayRole) return display(row, column);
+    if (role == SortRole) return sortKey(row, column);
+    if (role == Qt::DecorationRole && column == NameColumn) return thumbnail(row);
+    return QVariant();
+}
+
+QVariant ProductTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal
+        || section < 0 || section >= m_columns.size())
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch (m_columns[section]) {
+    case IdColumn: return QStringLiteral("ID");
+    case NameColumn: return QStringLiteral("Name");
+    case CategoryColumn: return QStringLiteral("Category");
+    case PriceColumn: return QStringLiteral("Price");
+    case StockColumn: return QStringLiteral("Stock");
+    case StatusColumn: return QStringLiteral("Status");
+    case SellerColumn: return QStringLiteral("Seller");
+    case DateColumn: return QStringLiteral("Date");
+    }
+    return QVariant();
+}
+
+QVariant ProductTableModel::display(const ProductRow& row, Column column) const {
+    switch (column) {
+    case IdColumn: return row.productId;
+    case NameColumn: return row.name;
+    case CategoryColumn: return row.category;
+    case PriceColumn: return "$" + row.price.toString();
+    case StockColumn: return row.stock;
+    case StatusColumn: return Product::statusString(row.status);
+    case SellerColumn: return row.sellerUsername;
+    case DateColumn: return row.registrationDate.toString("yyyy-MM-dd");
+    }
+    return QVariant();
+}
+
+QVariant ProductTableModel::sortKey(const ProductRow& row, Column column) const {
+    switch (column) {
+    case PriceColumn: return row.price.cents();
+    case StatusColumn: return int(row.status);
+    case DateColumn: return row.registrationDate;
+    default: return display(row, column);
+    }
+}
+
+void ProductTableModel::setProducts(const QVector<Product*>& products) {
+    ProductRows rows;
+    rows.reserve(products.size());
+    for (const Product* p : products)
+        rows.append(rowFor(p));
+    setProducts(rows);
+}
+
+void ProductTableModel::setProducts(const ProductRows& rows) {
+    if (m_rows.isEmpty() || rows.isEmpty()) {
+        beginResetModel();
+        m_rows = rows;
+        endResetModel();
+        return;
+    }
+
+    removeMissing(rows);
+
+    QSet<int> kept;
+    kept.reserve(m_rows.size());
+    for (const ProductRow& row : m_rows)
+        kept.insert(row.productId);
+
+    // Rows before i already match 'rows'; walk forward inserting new runs
+    // and updating changed rows in place
+    int changedFirst = -1;
+    auto flushChanged = [&](int end) {
+        if (changedFirst < 0) return;
+        emit dataChanged(index(changedFirst, 0), index(end - 1, int(m_columns.size()) - 1));
+        changedFirst = -1;
+    };
+
+    int i = 0;
+    while (i < rows.size()) {
+        if (i < m_rows.size() && m_rows[i].productId == rows[i].productId) {
+            if (!sameRow(m_rows[i], rows[i])) {
+                m_rows[i] = rows[i];
+                if (changedFirst < 0) changedFirst = i;
+            } else {
+                flushChanged(i);
+            }
+            ++i;
+            continue;
+        }
+        flushChanged(i);
+
+        if (kept.contains(rows[i].productId)) {
+            // Same products in a different order: nothing to preserve
+            beginResetModel();
+            m_rows = rows;
+            endResetModel();
+            return;
+        }
+
+        int end = i;
+        while (end < rows.size() && !kept.contains(rows[end].productId))
+            ++end;
+        beginInsertRows(QModelIndex(), i, end - 1);
+        m_rows = m_rows.first(i) + rows.sliced(i, end - i) + m_rows.sliced(i);
+        endInsertRows();
+        i = end;
+    }
+    flushChanged(i);
+}
+
+void ProductTableModel::removeMissing(const ProductRows& rows) {
+    QSet<int> wanted;
+    wanted.reserve(rows.size());
+    for (const ProductRow& row : rows)
+        wanted.insert(row.productId);
+
+    // Backwards, one signal per contiguous run of removed rows
+    int last = int(m_rows.size()) - 1;
+    while (last >= 0) {
+        if (wanted.contains(m_rows[last].productId)) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !wanted.contains(m_rows[first - 1].productId))
+            --first;
+        beginRemoveRows(QModelIndex(), first, last);
+        m_rows.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+}
+
+void ProductTableModel::setShowThumbnails(bool show) {
+    m_showThumbnails = show;
+}
+
+void ProductTableModel::setThumbnail(const QString& imageHash, const QPixmap& pixmap) {
+    m_thumbnailsWanted.remove(imageHash);
+    if (pixmap.isNull()) return;
+    m_thumbnails.insert(imageHash, new QPixmap(pixmap));
+
+    // Views repaint only the visible cells, so one signal over the column
+    // is cheaper than looking up the rows that use this image
+    int column = int(m_columns.indexOf(NameColumn));
+    if (column >= 0 && !m_rows.isEmpty())
+        emit dataChanged(index(0, column), index(int(m_rows.size()) - 1, column),
+                         {Qt::DecorationRole});
+}
+
+QVariant ProductTableModel::thumbnail(const ProductRow& row) const {
+    if (!m_showThumbnails || row.imageHash.isEmpty())
+        return QVariant();
+    if (QPixmap* pixmap = m_thumbnails.object(row.imageHash))
+        return *pixmap;
+    // Asked for from a paint; the receiver must not answer synchronously
+    if (!m_thumbnailsWanted.contains(row.imageHash)) {
+        m_thumbnailsWanted.insert(row.imageHash);
+        emit const_cast<ProductTableModel*>(this)->thumbnailNeeded(row.imageHash);
+    }
+    return QVariant();
+}
+
+void ProductTableModel::clear() {
+    setProducts(ProductRows());
+}
+
+int ProductTableModel::productIdAt(int row) const {
+    const ProductRow* r = rowAt(row);
+    return r ? r->productId : -1;
+}
+
+const ProductRow* ProductTableModel::rowAt(int row) const {
+    if (row < 0 || row >= m_rows.size()) return nullptr;
+    return &m_rows[row];
+}
+
+ProductRow ProductTableModel::rowFor(const Product* product) {
+    ProductRow row;
+    row.productId = product->getProductId();
+    row.name = product->getName();
+    row.category = product->getCategory();
+    row.price = product->getPrice();
+    row.stock = product->getStock();
+    row.sellerUsername = product->getSellerUsername();
+    row.status = product->getStatus();
+    row.imageHash = product->getImageHash();
+    row.description = product->getDescription();
+    row.registrationDate = product->getRegistrationDate();
+    return row;
+}
@@ -0,0 +1,181 @@
+#include "TextFormat.h"
+#include <charconv>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+QByteArrayView trimmed(QByteArrayView text) {
+    qsizetype begin = 0;
+    qsizetype end = text.size();
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t' || text[begin] == '\r'))
+        ++begin;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r'))
+        --end;
+    return text.sliced(begin, end - begin);
+}
+
+}
+
+namespace TextFormat {
+
+void appendInt(QByteArray& out, qint64 value) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, int(result.ptr - buffer));
+}
+
+void appendMoney(QByteArray& out, Money value) {
+    qint64 cents = value.cents();
+    if (cents < 0) {
+        out.append('-');
+        cents = -cents;
+    }
+    appendInt(out, cents / Money::Scale);
+    qint64 fraction = cents % Money::Scale;
+    out.append('.');
+    out.append(char('0' + fraction / 10));
+    out.append(char('0' + fraction % 10));
+}
+
+bool parseInt(QByteArrayView text, qint64& value) {
+    text = trimmed(text);
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    // from_chars rejects '+' but takes '-', so "+-5" must not reach it
+    if (begin != end && *begin == '+') {
+        ++begin;
+        if (begin != end && *begin == '-') return false;
+    }
+    auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool parseInt(QByteArrayView text, int& value) {
+    qint64 wide = 0;
+    if (!parseInt(text, wide) || wide < INT_MIN || wide > INT_MAX)
+        return false;
+    value = int(wide);
+    return true;
+}
+
+bool parseMoney(QByteArrayView text, Money& value) {
+    bool ok = false;
+    Money parsed = Money::fromUtf8(trimmed(text), &ok);
+    if (ok) value = parsed;
+    return ok;
+}
+
+int toInt(QByteArrayView text) {
+    int value = 0;
+    return parseInt(text, value) ? value : 0;
+}
+
+Money toMoney(QByteArrayView text) {
+    Money value;
+    return parseMoney(text, value) ? value : Money();
+}
+
+}
+
+// RowWriter
+
+RowWriter::RowWriter(QByteArray& out, char separator)
+    : m_out(out), m_separator(separator), m_first(true) {
+}
+
+void RowWriter::separate() {
+    if (!m_first) m_out.append(m_separator);
+    m_first = false;
+}
+
+RowWriter& RowWriter::operator<<(int value) {
+    separate();
+    TextFormat::appendInt(m_out, value);
+    return *this;
+}
+
+RowWriter& RowWriter::operator<<(qint64 value) {
+    separate();
+    TextFormat::appendInt(m_out, value);
+    return *this;
+}
+
+RowWriter& RowWriter::operator<<(Money value) {
+    separate();
+    TextFormat::appendMoney(m_out, value);
+    return *this;
+}
+
+RowWriter& RowWriter::operator<<(const QString& text) {
+    separate();
+    m_out.append(text.toUtf8());
+    return *this;
+}
+
+RowWriter& RowWriter::operator<<(QByteArrayView text) {
+    separate();
+    m_out.append(text.data(), text.size());
+    return *this;
+}
+
+void RowWriter::endRow() {
+    m_out.append('\n');
+    m_first = true;
+}
+
+// FieldReader
+
+FieldReader::FieldReader(QByteArrayView line, char separator, Quoting quoting)
+    : m_line(line), m_pos(0), m_separator(separator), m_quoting(quoting) {
+    // Tolerate lines handed over with their terminator
+    while (!m_line.isEmpty() && (m_line.back() == '\n' || m_line.back() == '\r'))
+        m_line = m_line.chopped(1);
+}
+
+QByteArrayView FieldReader::next() {
+    if (atEnd()) return QByteArrayView();
+
+    qsizetype start = m_pos;
+    qsizetype i = m_pos;
+    const qsizetype n = m_line.size();
+    bool quoted = false;
+    while (i < n) {
+        char c = m_line[i];
+        if (m_quoting == CsvQuotes && c == '"')
+            quoted = !quoted; // a doubled quote toggles twice
+        else if (c == m_separator && !quoted)
+            break;
+        ++i;
+    }
+    m_pos = i + 1;
+    return m_line.sliced(start, i - start);
+}
+
+int FieldReader::count() const {
+    FieldReader copy(*this);
+    copy.m_pos = 0;
+    int fields = 0;
+    while (!copy.atEnd()) {
+        copy.next();
+        ++fields;
+    }
+    return fields;
+}
+
+// LineReader
+
+bool LineReader::next(QByteArrayView& line) {
+    if (m_pos >= m_text.size()) return false;
+
+    const char* start = m_text.data() + m_pos;
+    qsizetype remaining = m_text.size() - m_pos;
+    const char* newline = static_cast<const char*>(std::memchr(start, '\n', size_t(remaining)));
+    qsizetype length = newline ? newline - start : remaining;
+    m_pos += newline ? length + 1 : length;
+
+    if (length > 0 && start[length - 1] == '\r')
+        --length;
+    line = QByteArrayView(start, length);
+    return true;
+}
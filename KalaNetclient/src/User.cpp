@@ -15,17 +15,17 @@ void Transaction::loadFromStream(QDataStream& stream) {
 
 // User base class implementation
 User::User() 
-    : walletBalance(0.0), userType(UserType::CUSTOMER) {
+    : walletBalance(), userType(UserType::CUSTOMER) {
 }
 
 User::User(const QString& user, const QString& pass, const QString& mail, 
            const QString& ph, const QString& addr, UserType type)
     : username(user), hashedPassword(pass), email(mail), 
-      phone(ph), address(addr), walletBalance(0.0), userType(type) {
+      phone(ph), address(addr), walletBalance(), userType(type) {
 }
 
-bool User::deductFunds(double amount) {
-    if (amount <= 0 || amount > walletBalance) {
+bool User::deductFunds(Money amount) {
+    if (amount <= Money() || amount > walletBalance) {
         return false;
     }
     walletBalance -= amount;
@@ -0,0 +1,148 @@
+#include <QApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QTableView>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include "NetworkManager.h"
+#include "ProductTableModel.h"
+#include "TextFormat.h"
+
+// UI frame-time benchmark: a 60 Hz timer on the GUI thread measures how
+// late each frame is while the approved catalog is fetched repeatedly from
+// a local server thread and loaded into a table view. With the default
+// threaded NetworkManager only the model update runs on the GUI thread;
+// --gui-thread keeps socket reads and row parsing there as before.
+// Usage: bench_frametime [rows] [rounds] [--gui-thread]   (default 200000 5)
+
+static QByteArray encodeCatalog(int rows) {
+    QByteArray out;
+    out.reserve(64 + qsizetype(rows) * 64);
+    RowWriter header(out, ' ');
+    header << "OK" << "APPROVED_PRODUCTS" << rows << "bench.1";
+    header.endRow();
+
+    RowWriter fields(out);
+    for (int i = 0; i < rows; ++i) {
+        fields << (i + 1) << QString("Product %1").arg(i) << "Electronics"
+               << Money::fromCents(100 + (i * 37) % 100000) << i % 50
+               << QString("seller%1").arg(i % 1000) << "Approved" << "";
+        fields.endRow();
+    }
+    return out;
+}
+
+int main(int argc, char *argv[]) {
+    QApplication app(argc, argv);
+
+    QStringList args = app.arguments().mid(1);
+    bool guiThread = args.removeAll("--gui-thread") > 0;
+    const int rows = args.size() > 0 ? args[0].toInt() : 200000;
+    const int rounds = args.size() > 1 ? args[1].toInt() : 5;
+    qDebug() << "=== KalaNet UI Frame-Time Benchmark ===" << rows << "rows," << rounds << "rounds,"
+             << (guiThread ? "network on GUI thread" : "network thread");
+
+    const QByteArray catalog = encodeCatalog(rows);
+
+    // Server on its own thread, answering every line with the catalog
+    QThread serverThread;
+    serverThread.start();
+    QObject serverContext;
+    serverContext.moveToThread(&serverThread);
+    QTcpServer* server = nullptr;
+    quint16 port = 0;
+    QMetaObject::invokeMethod(&serverContext, [&]() {
+        server = new QTcpServer();
+        server->listen(QHostAddress::LocalHost);
+        port = server->serverPort();
+        QObject::connect(server, &QTcpServer::newConnection, server, [server, &catalog]() {
+            QTcpSocket* socket = server->nextPendingConnection();
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket, &catalog]() {
+                while (socket->canReadLine()) {
+                    socket->readLine();
+                    socket->write(catalog);
+                }
+            });
+        });
+    }, Qt::BlockingQueuedConnection);
+
+    NetworkManager::setThreaded(!guiThread);
+    NetworkManager* net = NetworkManager::instance();
+
+    ProductTableModel model({ProductTableModel::IdColumn, ProductTableModel::NameColumn,
+                             ProductTableModel::PriceColumn, ProductTableModel::StockColumn});
+    QTableView view;
+    view.setModel(&model);
+    view.resize(800, 600);
+    view.show();
+
+    QVector<qint64> frames;
+    QElapsedTimer frameClock;
+    QTimer frameTimer;
+    frameTimer.setTimerType(Qt::PreciseTimer);
+    frameTimer.setInterval(16);
+    QObject::connect(&frameTimer, &QTimer::timeout, [&]() {
+        frames.append(frameClock.nsecsElapsed());
+        frameClock.restart();
+        view.viewport()->update();
+    });
+
+    QElapsedTimer roundClock;
+    qint64 totalRoundNs = 0;
+    int done = 0;
+    QObject::connect(net, &NetworkManager::approvedProductsReceived, &app,
+                     [&](const ProductRows& received, const QString&) {
+        model.setProducts(ProductRows()); // full load every round
+        model.setProducts(received);
+        totalRoundNs += roundClock.nsecsElapsed();
+        if (++done < rounds) {
+            roundClock.restart();
+            net->getApprovedProducts();
+        } else {
+            app.quit();
+        }
+    });
+    QObject::connect(net, &NetworkManager::connected, &app, [&]() {
+        frameClock.start();
+        frameTimer.start();
+        roundClock.start();
+        net->getApprovedProducts();
+    });
+    net->connectToServer("127.0.0.1", port);
+    app.exec();
+    frameTimer.stop();
+
+    if (!frames.isEmpty()) {
+        QVector<qint64> sorted = frames;
+        std::sort(sorted.begin(), sorted.end());
+        qint64 sum = 0;
+        int late = 0;
+        for (qint64 f : frames) {
+            sum += f;
+            if (f > 50 * 1000000LL) ++late;
+        }
+        auto ms = [](qint64 ns) { return QString::number(ns / 1e6, 'f', 1); };
+        qDebug().noquote() << QString("frames %1  avg %2 ms  p50 %3 ms  p99 %4 ms  max %5 ms  >50ms %6")
+                                  .arg(frames.size())
+                                  .arg(ms(sum / frames.size()))
+                                  .arg(ms(sorted[sorted.size() / 2]))
+                                  .arg(ms(sorted[qMin(int(sorted.size()) - 1, int(sorted.size() * 0.99))]))
+                                  .arg(ms(sorted.last()))
+                                  .arg(late);
+    }
+    if (done > 0)
+        qDebug().noquote() << QString("catalog round trip + model load: %1 ms avg")
+                                  .arg(totalRoundNs / done / 1e6, 0, 'f', 1);
+
+    NetworkManager::destroy();
+    QMetaObject::invokeMethod(&serverContext, [&]() { delete server; }, Qt::BlockingQueuedConnection);
+    serverThread.quit();
+    serverThread.wait();
+
+    qDebug() << "=== Benchmark Complete ===";
+    return 0;
+}
@@ -13,26 +13,9 @@ int main(int argc, char *argv[]) {
 
     NetworkManager* net = NetworkManager::instance();
 
-    // Try to connect to the server; retry on failure
-    while (true) {
-        if (net->connectToServer("127.0.0.1", 12345)) {
-            break;
-        }
-
-        QMessageBox::StandardButton reply = QMessageBox::critical(
-            nullptr,
-            "Connection Error",
-            "Cannot connect to the server.\n"
-            "Make sure the server is running on port 12345.\n\n"
-            "Do you want to retry?",
-            QMessageBox::Retry | QMessageBox::Abort
-            );
-
-        if (reply == QMessageBox::Abort) {
-            NetworkManager::destroy();
-            return 1;
-        }
-    }
+    // Connects in the background and keeps reconnecting after drops, so
+    // login and the cached catalog never wait for the server
+    net->connectToServer("127.0.0.1", 12345);
 
     // Main application loop – returns to login after logout
     while (true) {
@@ -62,7 +45,6 @@ int main(int argc, char *argv[]) {
         // Run event loop until the main window is destroyed
         QEventLoop loop;
         QObject::connect(mainWindow, &MainWindow::destroyed, &loop, &QEventLoop::quit);
-        QObject::connect(net, &NetworkManager::disconnected, &loop, &QEventLoop::quit);
         loop.exec();
 
         // Clean up - delete if not already deleted by deleteLater()
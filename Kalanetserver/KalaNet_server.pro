@@ -1,4 +1,4 @@
-QT       += core network
+QT       += core gui network
 
 CONFIG += c++17 console
 CONFIG -= qt_binpath
@@ -12,14 +12,42 @@ SOURCES += \
     src/main_server.cpp \
     src/Product.cpp \
     src/User.cpp \
+    src/Money.cpp \
+    src/TextFormat.cpp \
     src/DataManager.cpp \
-    src/Server.cpp
+    src/StringPool.cpp \
+    src/ProductCatalog.cpp \
+    src/PurchaseHistoryStore.cpp \
+    src/CartStore.cpp \
+    src/SalesLedger.cpp \
+    src/ImageStore.cpp \
+    src/Server.cpp \
+    src/ResponseCache.cpp \
+    src/IdleTimerWheel.cpp \
+    src/ConnectionRegistry.cpp \
+    src/ServerConfig.cpp \
+    src/ShardedServer.cpp
 
 HEADERS += \
     include/Product.h \
     include/User.h \
+    include/Money.h \
+    include/TextFormat.h \
     include/DataManager.h \
-    include/Server.h
+    include/StringPool.h \
+    include/Symbols.h \
+    include/ProductCatalog.h \
+    include/PurchaseHistoryStore.h \
+    include/Cart.h \
+    include/CartStore.h \
+    include/SalesLedger.h \
+    include/ImageStore.h \
+    include/Server.h \
+    include/ResponseCache.h \
+    include/IdleTimerWheel.h \
+    include/ConnectionRegistry.h \
+    include/ServerConfig.h \
+    include/ShardedServer.h
 
 INCLUDEPATH += include
 
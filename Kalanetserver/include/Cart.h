@@ -0,0 +1,81 @@
+#ifndef CART_H
+#define CART_H
+
+#include <QVarLengthArray>
+#include <QVector>
+#include <algorithm>
+
+struct CartItem {
+    int productId;
+    int quantity;
+};
+
+// A customer's cart as a flat array of items sorted by product id.
+// Carts hold a handful of items, so the first eight live inline in the
+// Customer and a lookup is a short binary search over contiguous memory.
+// Iteration order matches the QMap this replaced.
+class Cart {
+public:
+    using const_iterator = const CartItem*;
+
+    int size() const { return int(m_items.size()); }
+    bool isEmpty() const { return m_items.isEmpty(); }
+    const_iterator begin() const { return m_items.constData(); }
+    const_iterator end() const { return m_items.constData() + m_items.size(); }
+
+    bool contains(int productId) const { return quantity(productId) > 0; }
+    // 0 when the product is not in the cart
+    int quantity(int productId) const {
+        const_iterator it = lowerBound(productId);
+        return it != end() && it->productId == productId ? it->quantity : 0;
+    }
+
+    // A quantity of 0 or less removes the item
+    void set(int productId, int count) {
+        const_iterator it = lowerBound(productId);
+        qsizetype i = it - begin();
+        bool found = it != end() && it->productId == productId;
+        if (count <= 0) {
+            if (found) m_items.remove(i);
+        } else if (found) {
+            m_items[i].quantity = count;
+        } else {
+            m_items.insert(i, CartItem{productId, count});
+        }
+    }
+    void add(int productId, int count) { set(productId, quantity(productId) + count); }
+    void remove(int productId) { set(productId, 0); }
+    void clear() { m_items.clear(); }
+
+    // Items whose quantity differs between the carts, with their quantity in
+    // 'to' (0 for removed ones), in product id order
+    static QVector<CartItem> diff(const Cart& from, const Cart& to) {
+        QVector<CartItem> changes;
+        const_iterator a = from.begin();
+        const_iterator b = to.begin();
+        while (a != from.end() || b != to.end()) {
+            if (b == to.end() || (a != from.end() && a->productId < b->productId)) {
+                changes.append(CartItem{a->productId, 0});
+                ++a;
+            } else if (a == from.end() || b->productId < a->productId) {
+                changes.append(*b);
+                ++b;
+            } else {
+                if (a->quantity != b->quantity) changes.append(*b);
+                ++a;
+                ++b;
+            }
+        }
+        return changes;
+    }
+
+private:
+    const_iterator lowerBound(int productId) const {
+        return std::lower_bound(begin(), end(), productId,
+                                [](const CartItem& item, int id) { return item.productId < id; });
+    }
+
+    QVarLengthArray<CartItem, 8> m_items;
+};
+
+#endif // CART_H
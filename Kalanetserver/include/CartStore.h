@@ -0,0 +1,52 @@
+#ifndef CARTSTORE_H
+#define CARTSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include "Cart.h"
+
+class User;
+
+// Carts kept in carts.csv as a log of changes instead of a snapshot of
+// every cart. Each row sets one item of one user's cart to a quantity,
+// 0 removing it, and product id 0 empties the cart; a change to one cart
+// appends only its own rows. open() replays the log and compacts it when
+// most rows are superseded; compact() does the same from the live carts.
+// Files from before the log hold one row per item and read the same way.
+// Thread-safe.
+class CartStore {
+public:
+    explicit CartStore(const QString& path);
+
+    // Replays the log into 'carts' (username -> cart), creating the file
+    // with its header if needed
+    bool open(QHash<QString, Cart>& carts);
+    void close();
+
+    // Records new quantities for items of one user's cart in one write
+    bool append(const QString& username, const QVector<CartItem>& changes);
+    bool appendClear(const QString& username);
+    bool flush();
+
+    // Rewrites the log as one row per item of the customers' carts once
+    // superseded rows outnumber live ones
+    bool compact(const QVector<User*>& users);
+
+    int rowCount() const;
+    QString path() const { return m_file.fileName(); }
+
+private:
+    static void encode(QByteArray& out, const QString& username, const Cart& cart);
+    // Replaces the file with 'content' and reopens it for appending
+    bool replace(const QByteArray& content, int rows);
+    bool write(const QByteArray& out, int rows);
+
+    mutable QMutex m_mutex;
+    QFile m_file;
+    int m_rows; // data rows in the file
+};
+
+#endif // CARTSTORE_H
@@ -0,0 +1,57 @@
+#ifndef CONNECTIONREGISTRY_H
+#define CONNECTIONREGISTRY_H
+
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QString>
+#include <QDateTime>
+
+class ClientHandler;
+
+// Per-connection counters, owned by the ClientHandler they describe
+struct ConnectionStats {
+    quint64 id = 0;
+    QString peerAddress;
+    QString username;
+    QDateTime connectedAt;
+    QDateTime lastActivity;
+    quint64 bytesIn = 0;
+    quint64 bytesOut = 0;
+    quint64 commands = 0;
+};
+
+// Index of live connections. Every operation is an O(1) hash update, so
+// connection churn stays linear in the number of connects/disconnects.
+class ConnectionRegistry {
+public:
+    ConnectionRegistry();
+
+    // Assigns and returns a new connection id
+    quint64 insert(ClientHandler* handler, const QString& peerAddress);
+    void remove(ClientHandler* handler);
+    // Records that 'handler' is now authenticated as 'username'
+    void bindUser(ClientHandler* handler, const QString& username);
+
+    ClientHandler* byId(quint64 id) const;
+    QList<ClientHandler*> byUser(const QString& username) const;
+    QList<ClientHandler*> all() const;
+
+    int size() const { return m_byId.size(); }
+    int countForAddress(const QString& peerAddress) const;
+
+private:
+    struct Entry {
+        ClientHandler* handler;
+        QString peerAddress;
+        QString username;
+    };
+
+    quint64 m_nextId;
+    QHash<quint64, Entry> m_byId;
+    QHash<ClientHandler*, quint64> m_idByHandler;
+    QHash<QString, QSet<ClientHandler*>> m_byUser;
+    QHash<QString, int> m_perAddress;
+};
+
+#endif // CONNECTIONREGISTRY_H
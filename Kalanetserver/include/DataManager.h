@@ -7,8 +7,25 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QString>
+#include <QAtomicInt>
+#include <QSet>
 #include "User.h"
 #include "Product.h"
+#include "ProductCatalog.h"
+#include "FlatHashMap.h"
+#include "ObjectPool.h"
+#include "PurchaseHistoryStore.h"
+#include "CartStore.h"
+#include "SalesLedger.h"
+#include "ImageStore.h"
+
+class QTimer;
+
+// When mutations reach the CSV files
+enum class DurabilityMode {
+    Immediate, // rewrite the affected file on every change
+    Deferred   // mark dirty and write on the next flush interval
+};
 
 class DataManager : public QObject {
     Q_OBJECT
@@ -16,26 +33,85 @@ class DataManager : public QObject {
 private:
     static DataManager* instance;
     static QMutex instanceMutex;
+    static QString configuredDataDir;
+
+    FlatHashMap<QString, User*> users; // insertion-ordered for the CSV writer
+    ProductCatalog catalog; // column index over the Product objects
 
-    QMap<QString, User*> users;
-    QMap<int, Product*> products;
+    // Slab storage for the objects above; see createProduct()/createUser()
+    ObjectPool<Product> productPool;
+    ObjectPool<Customer> customerPool;
+    ObjectPool<Admin> adminPool;
+    // Objects handed to addUser()/addProduct() that did not come from a
+    // pool; everything else is freed chunk by chunk with its pool
+    QSet<User*> heapUsers;
+    QSet<Product*> heapProducts;
+    mutable QMutex poolMutex;
 
     int nextProductId;
+    quint64 catalogVersion; // bumped on every product change
+    qint64 catalogEpoch;    // startup time in ms, prefix of the catalog tag
     mutable QMutex dataMutex;
 
     QString dataDir;
     QString usersFile;
     QString productsFile;
+    PurchaseHistoryStore* historyStore; // transactions.csv, loaded per user on demand
+    CartStore* cartStore;               // carts.csv, appended as carts change
+    SalesLedger salesLedger;            // per-seller totals, rebuilt from transactions.csv
+    ImageStore* imageStore;             // product images by content hash
+
+    DurabilityMode durabilityMode;
+    QTimer* flushTimer;
+    QAtomicInt dirtyFiles;
+    // User/Product objects are not thread-safe; see getCommandMutex()
+    QMutex commandMutex;
 
     DataManager(QObject* parent = nullptr);
+    ~DataManager();
+    void markDirty(int files);
+    // Frees every user or product in O(chunks); the containers must be
+    // dropped by the caller
+    void releaseAllUsers();
+    void releaseAllProducts();
 
+public:
     // CSV helpers
-    QString escapeCSV(const QString& str);
-    QString unescapeCSV(const QString& str);
+    static QString escapeCSV(const QString& str);
+    static QString unescapeCSV(const QString& str);
 
-public:
     static DataManager* getInstance();
     static void destroyInstance();
+    // Must be called before the first getInstance(); empty means ./data
+    static void setDataDirectory(const QString& path);
+    QString getDataDirectory() const { return dataDir; }
+
+    void setDurabilityMode(DurabilityMode mode, int flushIntervalMs = 1000);
+    DurabilityMode getDurabilityMode() const { return durabilityMode; }
+    // Writes every file marked dirty in Deferred mode. Takes the command
+    // mutex, so it must not be called with it held.
+    bool flush();
+    // Held by every server command that reads or changes User/Product
+    // objects, so commands from different worker threads run one at a
+    // time and a deferred flush never sees a half-applied one
+    QMutex* getCommandMutex() { return &commandMutex; }
+    // Bound on purchase-history rows kept in memory
+    void setHistoryCacheCapacity(int transactions);
+    PurchaseHistoryStore* getHistoryStore() const { return historyStore; }
+    CartStore* getCartStore() const { return cartStore; }
+    const SalesLedger& getSalesLedger() const { return salesLedger; }
+    ImageStore* getImageStore() const { return imageStore; }
+
+    // Object allocation. Users and products handed to addUser()/addProduct()
+    // should come from here; release*() also accepts plain 'new' objects.
+    // Teardown and reloads free pooled objects by whole chunks.
+    User* createUser(UserType type, const QString& username, const QString& password,
+                     const QString& email, const QString& phone, const QString& address);
+    Product* createProduct(int id, const QString& name, const QString& description,
+                           const QString& category, Money price, int stock,
+                           const QString& seller);
+    void releaseUser(User* user);
+    void releaseProduct(Product* product);
 
     // User management
     bool addUser(User* user);
@@ -47,11 +123,16 @@ public:
     // Product management
     bool addProduct(Product* product);
     Product* getProduct(int productId);
+    // Call after modifying a Product in place so the catalog columns follow
+    void updateProduct(Product* product);
     bool removeProduct(int productId);
     QVector<Product*> getAllProducts() const;
     QVector<Product*> getApprovedProducts() const;
     QVector<Product*> getPendingProducts() const;
     QVector<Product*> getProductsByCategory(const QString& category) const;
+    QVector<Product*> getProductsBySeller(const QString& seller) const;
+    QVector<Product*> getProductsInPriceRange(Money minPrice, Money maxPrice) const;
+    QVector<Product*> getProductsSortedByPrice(bool ascending) const;
     QVector<Product*> searchProducts(const QString& searchTerm) const;
 
     // Approval system
@@ -61,15 +142,24 @@ public:
     // ID generation
     int getNextProductId();
 
+    // Catalog versioning (used to invalidate cached responses)
+    quint64 getCatalogVersion() const;
+    // Version as sent to clients, "<start time>.<version>", so a client's
+    // cached catalog never matches a restarted server by accident
+    QByteArray getCatalogTag() const;
+    void notifyCatalogChanged();
+
     // CSV Data persistence
     bool saveAllData();
     bool loadAllData();
 
-    // Legacy method names for compatibility (call CSV versions)
-    bool saveUsers() { return saveUsersToCSV(); }
+    // Legacy method names for compatibility. The save variants honour the
+    // durability mode; saveAllData() and the *ToCSV methods always write.
+    bool saveUsers();
     bool loadUsers() { return loadUsersFromCSV(); }
-    bool saveProducts() { return saveProductsToCSV(); }
+    bool saveProducts();
     bool loadProducts() { return loadProductsFromCSV(); }
+    bool saveChanges();
 
     bool saveUsersToCSV();
     bool loadUsersFromCSV();
@@ -82,7 +172,7 @@ public:
 
     // Statistics
     int getTotalUsers() const { return users.size(); }
-    int getTotalProducts() const { return products.size(); }
+    int getTotalProducts() const { return catalog.size(); }
     int getPendingCount() const;
 
 signals:
@@ -0,0 +1,171 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <QVector>
+#include <QHash>
+
+// Open-addressing hash map with linear probing.
+// Entries are kept densely in insertion order; the probe table only holds
+// indexes into them. Each entry stores its full hash, so a probe compares
+// keys only when the hashes match, and iteration walks one contiguous array
+// in a stable order (the ordered view the CSV writers rely on).
+template <typename Key, typename T>
+class FlatHashMap {
+public:
+    struct Entry {
+        Key key;
+        T value;
+        size_t hash;
+        bool live;
+    };
+
+    FlatHashMap() : m_size(0), m_used(0) {}
+
+    // Seeded per process like QHash, so keys cannot be picked to collide
+    static size_t hashOf(const Key& key) { return qHash(key, QHashSeed::globalSeed()); }
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+
+    void clear() {
+        m_entries.clear();
+        m_index.clear();
+        m_size = 0;
+        m_used = 0;
+    }
+
+    void reserve(int count) {
+        m_entries.reserve(count);
+        if (capacityFor(count) > m_index.size()) rehash(capacityFor(count));
+    }
+
+    // Lookups; the overloads taking 'hash' skip re-hashing the key
+    T* find(const Key& key, size_t hash) {
+        int i = findEntry(key, hash);
+        return i < 0 ? nullptr : &m_entries[i].value;
+    }
+    const T* find(const Key& key, size_t hash) const {
+        int i = findEntry(key, hash);
+        return i < 0 ? nullptr : &m_entries[i].value;
+    }
+    T* find(const Key& key) { return find(key, hashOf(key)); }
+    const T* find(const Key& key) const { return find(key, hashOf(key)); }
+
+    bool contains(const Key& key) const { return findEntry(key, hashOf(key)) >= 0; }
+
+    T value(const Key& key, const T& defaultValue = T()) const {
+        const T* v = find(key);
+        return v ? *v : defaultValue;
+    }
+
+    // Inserts or overwrites
+    void insert(const Key& key, const T& value) {
+        size_t hash = hashOf(key);
+        int i = findEntry(key, hash);
+        if (i >= 0) {
+            m_entries[i].value = value;
+            return;
+        }
+        if (capacityFor(m_used + 1) > m_index.size())
+            rehash(capacityFor(m_size + 1));
+
+        int slot = probeFree(hash);
+        if (m_index[slot] == Empty) ++m_used;
+        m_index[slot] = m_entries.size();
+        m_entries.append(Entry{key, value, hash, true});
+        ++m_size;
+    }
+
+    bool remove(const Key& key) {
+        size_t hash = hashOf(key);
+        int slot = findSlot(key, hash);
+        if (slot < 0) return false;
+
+        Entry& entry = m_entries[m_index[slot]];
+        entry.live = false;
+        entry.key = Key();
+        entry.value = T();
+        m_index[slot] = Tombstone;
+        --m_size;
+
+        // Compact once dead entries dominate
+        if (m_entries.size() > 16 && m_size < m_entries.size() / 2)
+            rehash(capacityFor(m_size));
+        return true;
+    }
+
+    // Visits live entries in insertion order
+    template <typename Func>
+    void forEach(Func func) const {
+        for (const Entry& entry : m_entries) {
+            if (entry.live) func(entry.key, entry.value);
+        }
+    }
+
+    QVector<T> values() const {
+        QVector<T> result;
+        result.reserve(m_size);
+        forEach([&result](const Key&, const T& value) { result.append(value); });
+        return result;
+    }
+
+private:
+    enum : int { Empty = -1, Tombstone = -2 };
+
+    // Keep the probe table at most half full
+    static int capacityFor(int count) {
+        int capacity = 16;
+        while (capacity < count * 2) capacity <<= 1;
+        return capacity;
+    }
+
+    int findSlot(const Key& key, size_t hash) const {
+        if (m_index.isEmpty()) return -1;
+        const int mask = m_index.size() - 1;
+        const int* index = m_index.constData();
+        for (int slot = int(hash & size_t(mask));; slot = (slot + 1) & mask) {
+            int e = index[slot];
+            if (e == Empty) return -1;
+            if (e >= 0 && m_entries[e].hash == hash && m_entries[e].key == key)
+                return slot;
+        }
+    }
+
+    int findEntry(const Key& key, size_t hash) const {
+        int slot = findSlot(key, hash);
+        return slot < 0 ? -1 : m_index[slot];
+    }
+
+    int probeFree(size_t hash) const {
+        const int mask = m_index.size() - 1;
+        int slot = int(hash & size_t(mask));
+        while (m_index[slot] >= 0) slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void rehash(int capacity) {
+        // Drop dead entries, keeping insertion order
+        QVector<Entry> live;
+        live.reserve(m_size);
+        for (const Entry& entry : m_entries) {
+            if (entry.live) live.append(entry);
+        }
+        m_entries.swap(live);
+
+        m_index.fill(Empty, capacity);
+        const int mask = capacity - 1;
+        for (int i = 0; i < m_entries.size(); ++i) {
+            int slot = int(m_entries[i].hash & size_t(mask));
+            while (m_index[slot] != Empty) slot = (slot + 1) & mask;
+            m_index[slot] = i;
+        }
+        m_used = m_entries.size();
+    }
+
+    QVector<Entry> m_entries;
+    QVector<int> m_index;
+    int m_size;   // live entries
+    int m_used;   // probe slots that are not Empty (live + tombstones)
+};
+
+#endif // FLATHASHMAP_H
@@ -0,0 +1,46 @@
+#ifndef IDLETIMERWHEEL_H
+#define IDLETIMERWHEEL_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+
+// Hashed timer wheel that tracks idle connections with a single QTimer.
+// touch() only records the current tick, entries are re-bucketed lazily when
+// their slot comes round, so activity on a busy socket costs one hash write.
+class IdleTimerWheel : public QObject {
+    Q_OBJECT
+public:
+    explicit IdleTimerWheel(QObject* parent = nullptr);
+
+    void setTimeout(int seconds);
+    int timeout() const { return m_timeout; }
+
+    void add(QObject* object);
+    void touch(QObject* object);
+    void remove(QObject* object);
+    int size() const { return m_entries.size(); }
+
+signals:
+    void expired(QObject* object);
+
+private slots:
+    void onTick();
+
+private:
+    struct Entry {
+        quint64 lastActive;
+        int bucket;
+    };
+
+    void schedule(QObject* object, Entry& entry, quint64 deadline);
+
+    QTimer m_timer; // parented so it follows moveToThread()
+    QVector<QVector<QObject*>> m_buckets;
+    QHash<QObject*, Entry> m_entries;
+    quint64 m_tick;
+    int m_timeout;
+};
+
+#endif // IDLETIMERWHEEL_H
@@ -0,0 +1,61 @@
+#ifndef IMAGESTORE_H
+#define IMAGESTORE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+#include <QStringView>
+
+// Content-addressed product images. Each blob is a file named by the
+// SHA-256 of its bytes under <directory>/<first two hex digits>/, so an
+// image uploaded twice is stored once and products only keep the hash.
+// Smaller sizes are scaled from the blob on first request and written
+// next to it; recently served images stay in a bounded memory cache.
+// Thread-safe.
+class ImageStore {
+public:
+    enum Size {
+        Thumb,  // 64x64, for product lists
+        Medium, // 200x200, for previews
+        Full    // the stored blob
+    };
+
+    // Encoded image at one size; etag changes whenever the bytes do
+    struct Image {
+        QByteArray data;
+        QString etag;
+        bool isNull() const { return data.isEmpty(); }
+    };
+
+    explicit ImageStore(const QString& directory);
+
+    // Stores 'data' unless a blob with the same hash exists; returns the
+    // hash, or an empty string if the data is not an image or can't be written
+    QString put(const QByteArray& data);
+    bool contains(const QString& hash) const;
+    // Null if the hash is unknown or the blob can't be decoded
+    Image image(const QString& hash, Size size);
+
+    // Limit on cached image bytes, in kilobytes
+    void setCacheCapacity(int kilobytes);
+
+    QString directory() const { return m_directory; }
+    QString pathFor(const QString& hash) const;
+
+    static QString hashOf(const QByteArray& data);
+    // True for a 64-digit lowercase hex string
+    static bool isValidHash(const QString& hash);
+    static bool parseSize(QStringView text, Size& size);
+    static const char* sizeName(Size size);
+
+private:
+    QString variantPath(const QString& hash, Size size) const;
+    QByteArray scale(const QByteArray& source, Size size) const;
+
+    QString m_directory;
+    mutable QMutex m_mutex;
+    QCache<QString, Image> m_cache; // "<hash>.<size>", cost in KB
+};
+
+#endif // IMAGESTORE_H
@@ -0,0 +1,103 @@
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <QVector>
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <utility>
+
+// Slab allocator for objects of one type.
+// Memory is taken in chunks of ChunkSize slots and recycled through an
+// intrusive free list, so bulk loads make one allocation per chunk and
+// tearing the pool down releases whole chunks. Not thread-safe.
+template <typename T, int ChunkSize = 256>
+class ObjectPool {
+public:
+    ObjectPool() : m_freeList(nullptr), m_live(0) {}
+    ~ObjectPool() { clear(); }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (!m_freeList) grow();
+        Slot* slot = m_freeList;
+        m_freeList = slot->next;
+        T* object = new (slot->storage) T(std::forward<Args>(args)...);
+        slot->live = true;
+        ++m_live;
+        return object;
+    }
+
+    // 'object' must come from this pool (see owns())
+    void destroy(T* object) {
+        if (!object) return;
+        Slot* slot = slotOf(object);
+        object->~T();
+        slot->live = false;
+        slot->next = m_freeList;
+        m_freeList = slot;
+        --m_live;
+    }
+
+    // O(log number of chunks). Chunks are unrelated arrays, so addresses
+    // are compared through std::less, which gives them a total order.
+    bool owns(const T* object) const {
+        const Slot* slot = reinterpret_cast<const Slot*>(object);
+        std::less<const Slot*> less;
+        auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), slot, less);
+        if (it == m_chunks.cbegin()) return false;
+        const Slot* chunk = *(it - 1);
+        return less(slot, chunk + ChunkSize);
+    }
+
+    // Destroys every live object and frees all chunks
+    void clear() {
+        for (Slot* chunk : m_chunks) {
+            for (int i = 0; i < ChunkSize; ++i) {
+                if (chunk[i].live)
+                    reinterpret_cast<T*>(chunk[i].storage)->~T();
+            }
+            delete[] chunk;
+        }
+        m_chunks.clear();
+        m_freeList = nullptr;
+        m_live = 0;
+    }
+
+    int liveCount() const { return m_live; }
+    int chunkCount() const { return m_chunks.size(); }
+
+private:
+    struct Slot {
+        // Storage comes first so a T* and its Slot* share an address
+        union {
+            Slot* next;
+            alignas(T) unsigned char storage[sizeof(T)];
+        };
+        bool live;
+    };
+
+    static Slot* slotOf(T* object) { return reinterpret_cast<Slot*>(object); }
+
+    void grow() {
+        Slot* chunk = new Slot[ChunkSize];
+        // Thread the free list so slots are handed out in address order
+        for (int i = 0; i < ChunkSize; ++i) {
+            chunk[i].live = false;
+            chunk[i].next = (i + 1 < ChunkSize) ? &chunk[i + 1] : m_freeList;
+        }
+        m_freeList = chunk;
+        // Kept in address order for owns()
+        auto it = std::lower_bound(m_chunks.begin(), m_chunks.end(), chunk, std::less<Slot*>());
+        m_chunks.insert(it, chunk);
+    }
+
+    QVector<Slot*> m_chunks;
+    Slot* m_freeList;
+    int m_live;
+};
+
+#endif // OBJECTPOOL_H
@@ -4,6 +4,9 @@
 #include <QString>
 #include <QDateTime>
 #include <QDataStream>
+#include "Money.h"
+
+class QImage;
 
 enum class ProductStatus {
     PENDING_APPROVAL,
@@ -16,18 +19,21 @@ private:
     int productId;
     QString name;
     QString description;
-    QString category;
-    double price;
+    int categoryId;      // interned in symbols()
+    QString category;    // symbols() string of categoryId, shared with the pool
+    Money price;
     int stock;
+    int sellerId;        // interned in symbols()
     QString sellerUsername;
     ProductStatus status;
     QDateTime registrationDate;
     QString imagePath;
+    QString imageHash;   // blob in DataManager's ImageStore
 
 public:
     Product();
     Product(int id, const QString& name, const QString& description, 
-            const QString& category, double price, int stock, 
+            const QString& category, Money price, int stock, 
             const QString& seller);
 
     // Getters
@@ -35,32 +41,40 @@ public:
     QString getName() const { return name; }
     QString getDescription() const { return description; }
     QString getCategory() const { return category; }
-    double getPrice() const { return price; }
+    int getCategoryId() const { return categoryId; }
+    Money getPrice() const { return price; }
     int getStock() const { return stock; }
     QString getSellerUsername() const { return sellerUsername; }
+    int getSellerId() const { return sellerId; }
     ProductStatus getStatus() const { return status; }
     QDateTime getRegistrationDate() const { return registrationDate; }
     QString getImagePath() const { return imagePath; }
+    QString getImageHash() const { return imageHash; }
 
     // Setters
     void setProductId(int id) { productId = id; }
     void setName(const QString& newName) { name = newName; }
     void setDescription(const QString& desc) { description = desc; }
-    void setCategory(const QString& cat) { category = cat; }
-    void setPrice(double newPrice) { price = newPrice; }
+    void setCategory(const QString& cat);
+    void setPrice(Money newPrice) { price = newPrice; }
     void setStock(int newStock) { stock = newStock; }
-    void setSellerUsername(const QString& seller) { sellerUsername = seller; }
+    void setSellerUsername(const QString& seller);
     void setStatus(ProductStatus newStatus) { status = newStatus; }
     void setRegistrationDate(const QDateTime& date) { registrationDate = date; }
     void setImagePath(const QString& path) { imagePath = path; }
+    void setImageHash(const QString& hash) { imageHash = hash; }
 
     // Status helpers
     bool isApproved() const { return status == ProductStatus::APPROVED; }
     bool isPending() const { return status == ProductStatus::PENDING_APPROVAL; }
     bool isSold() const { return status == ProductStatus::SOLD; }
+    bool hasImage() const { return !imageHash.isEmpty(); }
 
     QString getStatusString() const;
 
+    // Scales 'source' down to fit, keeping its aspect ratio
+    static QImage resizeImage(const QImage& source, int maxWidth, int maxHeight);
+
     // Serialization
     void saveToStream(QDataStream& stream) const;
     void loadFromStream(QDataStream& stream);
@@ -0,0 +1,61 @@
+#ifndef PRODUCTCATALOG_H
+#define PRODUCTCATALOG_H
+
+#include <QVector>
+#include <QHash>
+#include <QString>
+#include "Product.h"
+
+// Column-oriented index over the product set.
+// Hot scan fields (price, stock, status, category, seller) live in dense
+// parallel arrays ordered by product id, so filters and sorts stream
+// through contiguous memory instead of chasing Product pointers. Category
+// and seller are compared as symbols() ids. The
+// Product objects stay the owners of the full record and are handed back
+// to callers as views.
+class ProductCatalog {
+public:
+    ProductCatalog();
+
+    void clear();
+    // Inserts 'product' or refreshes its columns after it was modified
+    void upsert(Product* product);
+    // Removes the row; returns the Product so the caller can free it
+    Product* remove(int productId);
+
+    Product* product(int productId) const;
+    bool contains(int productId) const { return slotOf(productId) >= 0; }
+    int size() const { return m_ids.size(); }
+
+    // Scans, all returned in product id order unless stated otherwise
+    QVector<Product*> all() const;
+    QVector<Product*> withStatus(ProductStatus status) const;
+    int countWithStatus(ProductStatus status) const;
+    QVector<Product*> inCategory(const QString& category, ProductStatus status) const;
+    QVector<Product*> bySeller(const QString& seller) const;
+    QVector<Product*> inPriceRange(Money minPrice, Money maxPrice, ProductStatus status) const;
+    // Ordered by price, ties by id
+    QVector<Product*> sortedByPrice(ProductStatus status, bool ascending) const;
+
+private:
+    int slotOf(int productId) const;
+    void setSlot(int productId, int slot);
+    void writeRow(int slot, Product* product);
+    void reindexFrom(int slot);
+    QVector<Product*> materialize(const QVector<int>& slots) const;
+
+    // Product id -> slot. Ids below m_slotById.size() are indexed directly
+    // (-1 if absent); ids far past the live count go to m_sparseSlots so a
+    // stray huge id cannot size the array.
+    QVector<int> m_slotById;
+    QHash<int, int> m_sparseSlots;
+    QVector<int> m_ids;
+    QVector<qint64> m_prices;     // Money::cents()
+    QVector<int> m_stock;
+    QVector<quint8> m_status;
+    QVector<int> m_categoryIds;   // symbols() ids
+    QVector<int> m_sellerIds;     // symbols() ids
+    QVector<Product*> m_products;
+};
+
+#endif // PRODUCTCATALOG_H
@@ -0,0 +1,96 @@
+#ifndef PURCHASEHISTORYSTORE_H
+#define PURCHASEHISTORYSTORE_H
+
+#include <QByteArrayView>
+#include <QCache>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include "User.h"
+
+class SalesLedger;
+
+// Purchase histories kept in transactions.csv instead of in memory.
+// The file is append-only with one row per purchase; open() scans it once
+// and remembers the byte offset of every row per user, ordered by date.
+// A row is indexed under both the buyer and the seller. A history is read
+// back on first access and kept in a bounded LRU, so only recently viewed
+// histories stay resident. page() answers filtered, paged queries from the
+// index alone and reads only the rows it returns. Thread-safe.
+class PurchaseHistoryStore {
+public:
+    enum Role {
+        AsBuyer = 0x1,
+        AsSeller = 0x2,
+        AnyRole = AsBuyer | AsSeller
+    };
+
+    // Filter for page(). Invalid dates leave that end of the range open.
+    struct Query {
+        int roles = AnyRole;
+        QDateTime from;
+        QDateTime to;
+        int cursor = -1; // nextCursor of the previous page; -1 starts at the newest
+        int limit = 50;
+    };
+
+    // Newest first; nextCursor is 0 once there are no more matching rows
+    struct Page {
+        QVector<Transaction> rows;
+        int nextCursor = 0;
+    };
+
+    explicit PurchaseHistoryStore(const QString& path);
+
+    // Fed with every purchase on open() and append(); may be null
+    void setSalesLedger(SalesLedger* ledger);
+
+    // Builds the offset index, creating the file with its header if needed
+    bool open();
+    void close();
+
+    QVector<Transaction> history(const QString& username);
+    Page page(const QString& username, const Query& query);
+    int count(const QString& username) const;
+    // Records a purchase by 'username': one row in the file, indexed and
+    // cached for the buyer and the seller
+    bool append(const QString& username, const Transaction& trans);
+    bool flush();
+
+    // Limit on cached transactions across all histories
+    void setCacheCapacity(int transactions);
+    int cacheCapacity() const;
+    int cachedHistories() const;
+
+    QString path() const { return m_file.fileName(); }
+
+private:
+    struct IndexEntry {
+        qint64 offset;
+        qint64 time; // yyyyMMddhhmmss as a number, so it sorts like the date
+        int roles;
+    };
+
+    static qint64 timeKey(const QDateTime& date);
+    static qint64 timeKey(QByteArrayView text);
+    static QDateTime fromTimeKey(qint64 key);
+    static int rolesFor(const QString& username, const Transaction& trans);
+
+    // Adds 'entry' in date order; with 'trans' a cached history is extended too
+    void index(const QString& username, const IndexEntry& entry,
+               const Transaction* trans = nullptr);
+    bool parseRow(QByteArrayView line, Transaction& trans,
+                  QString* username = nullptr, qint64* time = nullptr) const;
+    void cache(const QString& username, const QVector<Transaction>& rows);
+
+    mutable QMutex m_mutex;
+    QFile m_file;
+    QHash<QString, QVector<IndexEntry>> m_index; // username -> rows by date
+    QCache<QString, QVector<Transaction>> m_cache;
+    SalesLedger* m_ledger;
+};
+
+#endif // PURCHASEHISTORYSTORE_H
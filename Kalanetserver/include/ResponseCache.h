@@ -0,0 +1,46 @@
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+class DataManager;
+
+// Caches encoded responses of read-only catalog commands.
+// Entries are tagged with the catalog version they were built from and the
+// whole cache is dropped as soon as DataManager reports a newer version.
+class ResponseCache : public QObject {
+    Q_OBJECT
+public:
+    explicit ResponseCache(DataManager* dm, QObject* parent = nullptr);
+
+    // Returns true and fills 'response' if a fresh entry exists for 'key'
+    bool lookup(const QString& key, QByteArray& response);
+    // 'version' must be the catalog version read before building 'response'
+    void insert(const QString& key, const QByteArray& response, quint64 version);
+
+    void setMaxEntries(int maxEntries);
+    int maxEntries() const { return m_maxEntries; }
+
+    quint64 hits() const { return m_hits; }
+    quint64 misses() const { return m_misses; }
+
+public slots:
+    void invalidate();
+
+private:
+    void syncVersion(quint64 current);
+
+    DataManager* m_dataManager;
+    QHash<QString, QByteArray> m_entries;
+    quint64 m_version;
+    int m_maxEntries;
+    quint64 m_hits;
+    quint64 m_misses;
+    QMutex m_mutex;
+};
+
+#endif // RESPONSECACHE_H
@@ -0,0 +1,53 @@
+#ifndef SALESLEDGER_H
+#define SALESLEDGER_H
+
+#include <QDate>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include "Money.h"
+#include "User.h"
+
+struct ProductSales {
+    int productId = 0;
+    QString productName;
+    int units = 0;
+    Money revenue;
+};
+
+struct DaySales {
+    QDate day;
+    int orders = 0;
+    int units = 0;
+    Money revenue;
+};
+
+// Running totals for one seller. The maps are implicitly shared, so
+// handing a summary out copies nothing.
+struct SalesSummary {
+    Money revenue;
+    int units = 0;
+    int orders = 0;
+    QMap<int, ProductSales> byProduct; // productId -> totals
+    QMap<QDate, DaySales> byDay;
+};
+
+// Sales indexed by seller. Every recorded transaction updates that
+// seller's totals in place, so a summary is a lookup rather than a scan
+// over purchase histories. Thread-safe.
+class SalesLedger {
+public:
+    void record(const Transaction& trans);
+    void clear();
+
+    SalesSummary summary(const QString& seller) const;
+    bool hasSales(const QString& seller) const;
+    int sellerCount() const;
+
+private:
+    mutable QMutex m_mutex;
+    QHash<QString, SalesSummary> m_sellers;
+};
+
+#endif // SALESLEDGER_H
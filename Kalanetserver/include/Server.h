@@ -5,12 +5,30 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QMap>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QMutex>
 #include "DataManager.h"
+#include "ResponseCache.h"
+#include "IdleTimerWheel.h"
+#include "ConnectionRegistry.h"
 
 class ClientHandler : public QObject {
     Q_OBJECT
 public:
-    explicit ClientHandler(QTcpSocket* socket, DataManager* dm, QObject* parent = nullptr);
+    explicit ClientHandler(QTcpSocket* socket, DataManager* dm, ResponseCache* cache,
+                           QObject* parent = nullptr);
+
+    // Sends 'reason' as an error and closes the connection
+    void closeConnection(const QString& reason);
+    // Sends an unsolicited message (e.g. a notification) to this client
+    void push(const QByteArray& message);
+
+    void setConnectionId(quint64 id) { m_stats.id = id; }
+    const ConnectionStats& stats() const { return m_stats; }
+
+signals:
+    void authenticated(const QString& username);
 
 private slots:
     void onReadyRead();
@@ -18,13 +36,31 @@ private slots:
 
 private:
     void processCommand(const QString& cmd);
+    // Raw bytes that followed a PUT_IMAGE line
+    void processUpload(const QByteArray& data);
     void sendResponse(const QString& response);
+    void sendEncoded(const QByteArray& response);
     void sendError(const QString& msg);
+    // Builds the response with 'build', caches it under 'key' and sends it
+    template <typename Builder>
+    void sendCached(const QString& key, Builder build);
 
     QTcpSocket* m_socket;
     DataManager* m_dataManager;
-    QString m_buffer;
+    ResponseCache* m_responseCache;
+    QByteArray m_buffer;
+    qint64 m_uploadExpected; // payload bytes still owed by PUT_IMAGE, or 0
     User* m_currentUser; // authenticated user for this client
+    ConnectionStats m_stats;
+};
+
+// Admission control for incoming connections. A value of 0 disables the limit.
+struct ServerLimits {
+    int maxConnections = 4096;
+    int maxConnectionsPerIp = 64;
+    int idleTimeoutSecs = 300;
+    int acceptsPerSecond = 500;  // token bucket refill rate
+    int acceptBurst = 1000;      // token bucket capacity
 };
 
 class Server : public QTcpServer {
@@ -32,13 +68,38 @@ class Server : public QTcpServer {
 public:
     explicit Server(QObject* parent = nullptr);
     bool start(quint16 port);
+    bool start(const QHostAddress& address, quint16 port);
+    ResponseCache* responseCache() const { return m_responseCache; }
+
+    void setLimits(const ServerLimits& limits);
+    const ServerLimits& limits() const { return m_limits; }
+    int connectionCount() const { return m_registry.size(); }
+    quint64 rejectedCount() const { return m_rejected; }
+
+    // Lookups for push notifications and admin tooling
+    ClientHandler* connection(quint64 id) const { return m_registry.byId(id); }
+    QList<ClientHandler*> connectionsForUser(const QString& username) const;
+    QList<ConnectionStats> connectionStats() const;
+    bool kickConnection(quint64 id, const QString& reason);
+    int notifyUser(const QString& username, const QString& message);
 
 protected:
     void incomingConnection(qintptr socketDescriptor) override;
 
 private:
+    void rejectConnection(QTcpSocket* socket, const QString& reason);
+    void throttleAccepts();
+    void onIdleExpired(QObject* object);
+
     DataManager* m_dataManager;
-    QList<ClientHandler*> m_clients;
+    ResponseCache* m_responseCache;
+    ConnectionRegistry m_registry;
+
+    ServerLimits m_limits;
+    IdleTimerWheel* m_idleWheel;
+    QElapsedTimer m_acceptClock;
+    double m_acceptTokens;
+    quint64 m_rejected;
 };
 
 #endif // SERVER_H
\ No newline at end of file
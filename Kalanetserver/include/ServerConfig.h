@@ -0,0 +1,33 @@
+#ifndef SERVERCONFIG_H
+#define SERVERCONFIG_H
+
+#include <QString>
+#include <QHostAddress>
+#include "DataManager.h"
+#include "Server.h"
+
+class QCoreApplication;
+
+// Runtime options for the standalone server. Values come from an optional
+// INI file (--config) and are then overridden by command-line flags.
+struct ServerConfig {
+    QHostAddress bindAddress = QHostAddress::Any;
+    quint16 port = 12345;          // 0 picks an ephemeral port
+    QString dataDir;               // empty means <cwd>/data
+    int workerThreads = 1;
+    DurabilityMode durability = DurabilityMode::Immediate;
+    int flushIntervalMs = 1000;
+    int responseCacheEntries = 256;
+    int historyCacheRows = 10000;  // purchase-history rows kept in memory
+    QString logLevel = "debug";    // debug, info, warning, critical
+    ServerLimits limits;
+
+    // Parses the application arguments; exits on --help/--version.
+    // Returns false and fills 'error' on invalid values.
+    static bool load(const QCoreApplication& app, ServerConfig& config, QString& error);
+
+    // Installs logging filter rules matching logLevel
+    void applyLogLevel() const;
+};
+
+#endif // SERVERCONFIG_H
@@ -0,0 +1,44 @@
+#ifndef SHARDEDSERVER_H
+#define SHARDEDSERVER_H
+
+#include <QObject>
+#include <QVector>
+#include <QThread>
+#include <QHostAddress>
+#include "Server.h"
+
+// Runs one Server per worker thread, each accepting on its own listening
+// socket bound to the same port with SO_REUSEPORT. The kernel spreads new
+// connections across the sockets, and every ClientHandler stays in the
+// thread that accepted it, so there is no cross-thread socket handoff.
+class ShardedServer : public QObject {
+    Q_OBJECT
+public:
+    explicit ShardedServer(int shards, QObject* parent = nullptr);
+    ~ShardedServer();
+
+    // Global limits; each shard gets an equal share
+    void setLimits(const ServerLimits& limits);
+    void setResponseCacheEntries(int entries);
+
+    bool start(const QHostAddress& address, quint16 port);
+    void stop();
+
+    quint16 serverPort() const { return m_port; }
+    QString errorString() const { return m_error; }
+    int shardCount() const { return m_servers.size(); }
+    int connectionCount() const;
+
+    // Whether this platform can share a port between listening sockets
+    static bool isSupported();
+
+private:
+    qintptr openListeningSocket(const QHostAddress& address, quint16 port);
+
+    QVector<QThread*> m_threads;
+    QVector<Server*> m_servers;
+    quint16 m_port;
+    QString m_error;
+};
+
+#endif // SHARDEDSERVER_H
@@ -0,0 +1,31 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QReadWriteLock>
+
+// Interns strings into small dense ids. Each distinct string is stored
+// once; equality between interned values is an integer compare.
+// Ids are never reused, so they stay valid for the life of the pool.
+class StringPool {
+public:
+    StringPool();
+
+    // Returns the id of 'str', adding it if needed
+    int intern(const QString& str);
+    // Returns the id of 'str', or -1 if it was never interned
+    int find(const QString& str) const;
+    // Returns a shallow copy of the interned string, or an empty one
+    QString string(int id) const;
+
+    int size() const;
+
+private:
+    QHash<QString, int> m_ids;
+    QVector<QString> m_strings;
+    mutable QReadWriteLock m_lock;
+};
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,14 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include "StringPool.h"
+
+// Process-wide symbol table for category and seller names. Kept out of
+// DataManager so Product and ProductCatalog do not depend on the singleton
+// and Products can be built before it exists.
+inline StringPool& symbols() {
+    static StringPool pool;
+    return pool;
+}
+
+#endif // SYMBOLS_H
@@ -0,0 +1,94 @@
+#ifndef TEXTFORMAT_H
+#define TEXTFORMAT_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include "Money.h"
+
+// Number formatting and parsing straight on UTF-8 bytes, built on
+// std::to_chars/std::from_chars. Used for protocol rows and CSV files so
+// numbers never round-trip through QString or allocate on their own.
+namespace TextFormat {
+
+void appendInt(QByteArray& out, qint64 value);
+void appendMoney(QByteArray& out, Money value);
+
+// Whole-field parses; surrounding spaces are ignored, anything else fails
+bool parseInt(QByteArrayView text, qint64& value);
+bool parseInt(QByteArrayView text, int& value);
+bool parseMoney(QByteArrayView text, Money& value);
+
+// Lenient forms returning 0 on malformed input, like QString::toInt()
+int toInt(QByteArrayView text);
+Money toMoney(QByteArrayView text);
+
+}
+
+// Appends one separator-delimited row to a byte buffer
+class RowWriter {
+public:
+    explicit RowWriter(QByteArray& out, char separator = '|');
+
+    RowWriter& operator<<(int value);
+    RowWriter& operator<<(qint64 value);
+    RowWriter& operator<<(Money value);
+    RowWriter& operator<<(const QString& text);
+    RowWriter& operator<<(QByteArrayView text);
+    RowWriter& operator<<(const QByteArray& text) { return *this << QByteArrayView(text); }
+    RowWriter& operator<<(const char* text) { return *this << QByteArrayView(text); }
+
+    // Terminates the row with '\n'; the next field starts a new row
+    void endRow();
+
+private:
+    void separate();
+
+    QByteArray& m_out;
+    char m_separator;
+    bool m_first;
+};
+
+// Splits one line into fields without copying it
+class FieldReader {
+public:
+    enum Quoting {
+        NoQuotes,  // separators always split
+        CsvQuotes  // separators inside "..." belong to the field
+    };
+
+    explicit FieldReader(QByteArrayView line, char separator = '|',
+                         Quoting quoting = NoQuotes);
+
+    bool atEnd() const { return m_pos > m_line.size(); }
+    // Returns the next field, or an empty view once atEnd()
+    QByteArrayView next();
+
+    QString nextString() { return QString::fromUtf8(next()); }
+    int nextInt() { return TextFormat::toInt(next()); }
+    Money nextMoney() { return TextFormat::toMoney(next()); }
+
+    // Number of fields in the line, without consuming any
+    int count() const;
+
+private:
+    QByteArrayView m_line;
+    qsizetype m_pos;
+    char m_separator;
+    Quoting m_quoting;
+};
+
+// Walks the lines of a buffer without copying them
+class LineReader {
+public:
+    explicit LineReader(QByteArrayView text) : m_text(text), m_pos(0) {}
+
+    // Sets 'line' to the next line without its "\n" or "\r\n"
+    bool next(QByteArrayView& line);
+
+private:
+    QByteArrayView m_text;
+    qsizetype m_pos;
+};
+
+#endif // TEXTFORMAT_H
@@ -6,9 +6,13 @@
 #include <QDataStream>
 #include <QVector>
 #include <QMap>
+#include "Money.h"
+#include "Cart.h"
 
 // Forward declarations
 class Product;
+class PurchaseHistoryStore;
+class CartStore;
 
 enum class UserType {
     ADMIN,
@@ -22,7 +26,7 @@ struct Transaction {
     QString sellerUsername;
     QString buyerUsername;
     int quantity;
-    double totalPrice;
+    Money totalPrice;
     QDateTime date;
 
     void saveToStream(QDataStream& stream) const;
@@ -36,7 +40,7 @@ protected:
     QString email;
     QString phone;
     QString address;
-    double walletBalance;
+    Money walletBalance;
     UserType userType;
 
 public:
@@ -51,7 +55,7 @@ public:
     QString getEmail() const { return email; }
     QString getPhone() const { return phone; }
     QString getAddress() const { return address; }
-    double getWalletBalance() const { return walletBalance; }
+    Money getWalletBalance() const { return walletBalance; }
     UserType getType() const { return userType; }
 
     // Setters
@@ -60,11 +64,11 @@ public:
     void setEmail(const QString& mail) { email = mail; }
     void setPhone(const QString& ph) { phone = ph; }
     void setAddress(const QString& addr) { address = addr; }
-    void setWalletBalance(double balance) { walletBalance = balance; }
+    void setWalletBalance(Money balance) { walletBalance = balance; }
 
     // Wallet operations
-    void addFunds(double amount) { walletBalance += amount; }
-    bool deductFunds(double amount);
+    void addFunds(Money amount) { walletBalance += amount; }
+    bool deductFunds(Money amount);
 
     // Virtual methods
     virtual UserType getUserType() const = 0;
@@ -96,10 +100,13 @@ public:
 
 class Customer : public User {
 private:
-    QMap<int, int> cart; // productId -> quantity
-    QVector<Transaction> purchaseHistory;
+    Cart cart;
+    QVector<Transaction> purchaseHistory; // only used without a history store
     QVector<int> registeredProductIds; // Products this customer registered
 
+    static PurchaseHistoryStore* historyStore;
+    static CartStore* cartStore;
+
 public:
     Customer();
     Customer(const QString& user, const QString& pass, const QString& mail, 
@@ -109,18 +116,25 @@ public:
     QString getUserTypeString() const override { return "Customer"; }
     bool canRegisterProducts() const override { return true; }
 
-    // Cart operations
+    // Cart operations. With a store attached (see DataManager) every change
+    // is appended to it as it happens.
+    static void setCartStore(CartStore* store) { cartStore = store; }
     void addToCart(int productId, int quantity);
+    void setCartQuantity(int productId, int quantity);
     void removeFromCart(int productId);
-    void clearCart() { cart.clear(); }
-    QMap<int, int>& getCart() { return cart; }
-    const QMap<int, int>& getCart() const { return cart; }
+    void clearCart();
+    // Replaces the whole cart, recording only the items that changed
+    void setCart(const Cart& newCart);
+    // Replaces the cart without recording it; used when loading
+    void restoreCart(const Cart& saved) { cart = saved; }
+    const Cart& getCart() const { return cart; }
     bool isInCart(int productId) const { return cart.contains(productId); }
 
-    // Purchase history
+    // Purchase history. With a store attached (see DataManager) it lives on
+    // disk and is loaded on first access.
+    static void setHistoryStore(PurchaseHistoryStore* store) { historyStore = store; }
     void addTransaction(const Transaction& trans);
-    QVector<Transaction>& getPurchaseHistory() { return purchaseHistory; }
-    const QVector<Transaction>& getPurchaseHistory() const { return purchaseHistory; }
+    QVector<Transaction> getPurchaseHistory() const;
 
     // Registered products
     void addRegisteredProduct(int productId);
@@ -0,0 +1,178 @@
+#include "CartStore.h"
+#include "DataManager.h"
+#include "TextFormat.h"
+#include "User.h"
+#include <QDebug>
+#include <QSaveFile>
+
+namespace {
+const char* const kHeader = "username,product_id,quantity\n";
+// Superseded rows tolerated regardless of how few carts are live
+const int kMinCompactRows = 1024;
+}
+
+CartStore::CartStore(const QString& path)
+    : m_file(path), m_rows(0) {
+}
+
+bool CartStore::open(QHash<QString, Cart>& carts) {
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) m_file.close();
+    m_rows = 0;
+
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qDebug() << "Failed to open carts file:" << m_file.fileName();
+        return false;
+    }
+    if (m_file.size() == 0) {
+        m_file.write(kHeader);
+        return m_file.flush();
+    }
+
+    QByteArray content = m_file.readAll();
+    LineReader lines(content);
+    QByteArrayView line;
+    lines.next(line); // header
+
+    while (lines.next(line)) {
+        FieldReader fields(line, ',', FieldReader::CsvQuotes);
+        if (fields.count() < 3) continue;
+        QString username = DataManager::unescapeCSV(fields.nextString());
+        int productId = fields.nextInt();
+        int quantity = fields.nextInt();
+        ++m_rows;
+
+        if (productId == 0)
+            carts.remove(username);
+        else
+            carts[username].set(productId, quantity);
+    }
+    for (auto it = carts.begin(); it != carts.end();) {
+        if (it->isEmpty())
+            it = carts.erase(it);
+        else
+            ++it;
+    }
+
+    int live = 0;
+    for (const Cart& cart : std::as_const(carts))
+        live += cart.size();
+    qDebug() << "Replayed" << m_rows << "cart rows into" << carts.size() << "carts";
+
+    if (m_rows - live > qMax(live, kMinCompactRows)) {
+        QByteArray out = kHeader;
+        for (auto it = carts.cbegin(); it != carts.cend(); ++it)
+            encode(out, it.key(), it.value());
+        return replace(out, live);
+    }
+
+    // Appends must start on a fresh line
+    if (!content.endsWith('\n')) {
+        m_file.write("\n");
+        m_file.flush();
+    }
+    return true;
+}
+
+void CartStore::close() {
+    QMutexLocker locker(&m_mutex);
+    m_file.close();
+    m_rows = 0;
+}
+
+bool CartStore::append(const QString& username, const QVector<CartItem>& changes) {
+    if (changes.isEmpty()) return true;
+
+    QByteArray out;
+    RowWriter row(out, ',');
+    QString user = DataManager::escapeCSV(username);
+    for (const CartItem& item : changes) {
+        row << user << item.productId << qMax(0, item.quantity);
+        row.endRow();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    return write(out, int(changes.size()));
+}
+
+bool CartStore::appendClear(const QString& username) {
+    QByteArray out;
+    RowWriter row(out, ',');
+    row << DataManager::escapeCSV(username) << 0 << 0;
+    row.endRow();
+
+    QMutexLocker locker(&m_mutex);
+    return write(out, 1);
+}
+
+bool CartStore::flush() {
+    QMutexLocker locker(&m_mutex);
+    return !m_file.isOpen() || m_file.flush();
+}
+
+bool CartStore::compact(const QVector<User*>& users) {
+    QVector<const Customer*> customers;
+    int live = 0;
+    for (User* user : users) {
+        if (const Customer* customer = dynamic_cast<const Customer*>(user)) {
+            customers.append(customer);
+            live += customer->getCart().size();
+        }
+    }
+
+    // Held across the snapshot so no append lands between it and the rewrite
+    QMutexLocker locker(&m_mutex);
+    if (m_rows - live <= qMax(live, kMinCompactRows))
+        return true;
+
+    QByteArray out = kHeader;
+    for (const Customer* customer : customers)
+        encode(out, customer->getUsername(), customer->getCart());
+    return replace(out, live);
+}
+
+int CartStore::rowCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_rows;
+}
+
+void CartStore::encode(QByteArray& out, const QString& username, const Cart& cart) {
+    if (cart.isEmpty()) return;
+    RowWriter row(out, ',');
+    QString user = DataManager::escapeCSV(username);
+    for (const CartItem& item : cart) {
+        row << user << item.productId << item.quantity;
+        row.endRow();
+    }
+}
+
+bool CartStore::replace(const QByteArray& content, int rows) {
+    QString path = m_file.fileName();
+    m_file.close();
+
+    QSaveFile file(path);
+    bool saved = file.open(QIODevice::WriteOnly) && file.write(content) == content.size()
+                 && file.commit();
+    if (!saved)
+        qDebug() << "Failed to compact carts file:" << path;
+    else
+        m_rows = rows;
+
+    // The old log is still complete if the rewrite failed
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qDebug() << "Failed to reopen carts file:" << path;
+        return false;
+    }
+    return saved;
+}
+
+bool CartStore::write(const QByteArray& out, int rows) {
+    if (!m_file.isOpen() || !m_file.seek(m_file.size()))
+        return false;
+    if (m_file.write(out) != out.size() || !m_file.flush()) {
+        qDebug() << "Failed to append to carts file:" << m_file.fileName();
+        return false;
+    }
+    m_rows += rows;
+    return true;
+}
@@ -0,0 +1,72 @@
+#include "ConnectionRegistry.h"
+
+ConnectionRegistry::ConnectionRegistry() : m_nextId(1) {
+}
+
+quint64 ConnectionRegistry::insert(ClientHandler* handler, const QString& peerAddress) {
+    quint64 id = m_nextId++;
+    m_byId.insert(id, Entry{handler, peerAddress, QString()});
+    m_idByHandler.insert(handler, id);
+    m_perAddress[peerAddress]++;
+    return id;
+}
+
+void ConnectionRegistry::remove(ClientHandler* handler) {
+    auto idIt = m_idByHandler.find(handler);
+    if (idIt == m_idByHandler.end()) return;
+
+    auto it = m_byId.find(idIt.value());
+    if (it != m_byId.end()) {
+        if (!it->username.isEmpty()) {
+            auto userIt = m_byUser.find(it->username);
+            if (userIt != m_byUser.end()) {
+                userIt->remove(handler);
+                if (userIt->isEmpty()) m_byUser.erase(userIt);
+            }
+        }
+        auto addrIt = m_perAddress.find(it->peerAddress);
+        if (addrIt != m_perAddress.end() && --addrIt.value() <= 0)
+            m_perAddress.erase(addrIt);
+        m_byId.erase(it);
+    }
+    m_idByHandler.erase(idIt);
+}
+
+void ConnectionRegistry::bindUser(ClientHandler* handler, const QString& username) {
+    auto idIt = m_idByHandler.constFind(handler);
+    if (idIt == m_idByHandler.constEnd()) return;
+
+    Entry& entry = m_byId[idIt.value()];
+    if (entry.username == username) return;
+
+    // Re-login on the same connection as someone else
+    if (!entry.username.isEmpty()) {
+        auto userIt = m_byUser.find(entry.username);
+        if (userIt != m_byUser.end()) {
+            userIt->remove(handler);
+            if (userIt->isEmpty()) m_byUser.erase(userIt);
+        }
+    }
+    entry.username = username;
+    if (!username.isEmpty())
+        m_byUser[username].insert(handler);
+}
+
+ClientHandler* ConnectionRegistry::byId(quint64 id) const {
+    auto it = m_byId.constFind(id);
+    return it == m_byId.constEnd() ? nullptr : it->handler;
+}
+
+QList<ClientHandler*> ConnectionRegistry::byUser(const QString& username) const {
+    auto it = m_byUser.constFind(username);
+    if (it == m_byUser.constEnd()) return QList<ClientHandler*>();
+    return QList<ClientHandler*>(it->begin(), it->end());
+}
+
+QList<ClientHandler*> ConnectionRegistry::all() const {
+    return m_idByHandler.keys();
+}
+
+int ConnectionRegistry::countForAddress(const QString& peerAddress) const {
+    return m_perAddress.value(peerAddress, 0);
+}
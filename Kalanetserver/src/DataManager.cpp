@@ -1,20 +1,45 @@
 #include "DataManager.h"
+#include "TextFormat.h"
 #include <QFile>
+#include <QDateTime>
 #include <QDir>
 #include <QDebug>
-#include <QTextStream>
 #include <QStandardPaths>
+#include <QTimer>
 
 DataManager* DataManager::instance = nullptr;
 QMutex DataManager::instanceMutex;
+QString DataManager::configuredDataDir;
 
-DataManager::DataManager(QObject* parent)
-    : QObject(parent), nextProductId(1) {
+namespace {
+enum DirtyFile {
+    DirtyUsers = 0x1,
+    DirtyProducts = 0x2,
+    DirtyAll = 0x4
+};
+}
 
-    // Use application directory for data storage
-    dataDir = QDir::currentPath() + "/data";
+DataManager::DataManager(QObject* parent)
+    : QObject(parent), nextProductId(1), catalogVersion(0),
+      catalogEpoch(QDateTime::currentMSecsSinceEpoch()),
+      durabilityMode(DurabilityMode::Immediate), dirtyFiles(0) {
+
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(1000);
+    connect(flushTimer, &QTimer::timeout, this, &DataManager::flush);
+
+    // Use application directory for data storage unless configured
+    dataDir = configuredDataDir.isEmpty() ? QDir::currentPath() + "/data"
+                                          : QDir(configuredDataDir).absolutePath();
     usersFile = dataDir + "/users.csv";
     productsFile = dataDir + "/products.csv";
+    historyStore = new PurchaseHistoryStore(dataDir + "/transactions.csv");
+    historyStore->setSalesLedger(&salesLedger);
+    Customer::setHistoryStore(historyStore);
+    cartStore = new CartStore(dataDir + "/carts.csv");
+    Customer::setCartStore(cartStore);
+    imageStore = new ImageStore(dataDir + "/images");
 
     // Ensure data directory exists
     QDir dir;
@@ -30,6 +55,19 @@ DataManager::DataManager(QObject* parent)
     loadAllData();
 }
 
+DataManager::~DataManager() {
+    users.clear();
+    releaseAllUsers();
+    catalog.clear();
+    releaseAllProducts();
+
+    Customer::setHistoryStore(nullptr);
+    Customer::setCartStore(nullptr);
+    delete historyStore;
+    delete cartStore;
+    delete imageStore;
+}
+
 DataManager* DataManager::getInstance() {
     QMutexLocker locker(&instanceMutex);
     if (instance == nullptr) {
@@ -38,6 +76,66 @@ DataManager* DataManager::getInstance() {
     return instance;
 }
 
+void DataManager::setDataDirectory(const QString& path) {
+    QMutexLocker locker(&instanceMutex);
+    if (instance != nullptr) {
+        qDebug() << "Data directory must be set before DataManager is created";
+        return;
+    }
+    configuredDataDir = path;
+}
+
+void DataManager::setDurabilityMode(DurabilityMode mode, int flushIntervalMs) {
+    durabilityMode = mode;
+    flushTimer->setInterval(qMax(0, flushIntervalMs));
+    if (mode == DurabilityMode::Immediate)
+        flush();
+}
+
+void DataManager::markDirty(int files) {
+    dirtyFiles.fetchAndOrOrdered(files);
+    // The timer lives in this object's thread; hop there if needed
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!flushTimer->isActive()) flushTimer->start();
+    }, Qt::AutoConnection);
+}
+
+bool DataManager::flush() {
+    // The timer fires on this thread while workers may be mid-command
+    QMutexLocker commandLocker(&commandMutex);
+    int files = dirtyFiles.fetchAndStoreOrdered(0);
+    if (files & DirtyAll) return saveAllData();
+
+    bool success = true;
+    if (files & DirtyUsers) success &= saveUsersToCSV();
+    if (files & DirtyProducts) success &= saveProductsToCSV();
+    return success;
+}
+
+bool DataManager::saveUsers() {
+    if (durabilityMode == DurabilityMode::Deferred) {
+        markDirty(DirtyUsers);
+        return true;
+    }
+    return saveUsersToCSV();
+}
+
+bool DataManager::saveProducts() {
+    if (durabilityMode == DurabilityMode::Deferred) {
+        markDirty(DirtyProducts);
+        return true;
+    }
+    return saveProductsToCSV();
+}
+
+bool DataManager::saveChanges() {
+    if (durabilityMode == DurabilityMode::Deferred) {
+        markDirty(DirtyAll);
+        return true;
+    }
+    return saveAllData();
+}
+
 void DataManager::destroyInstance() {
     QMutexLocker locker(&instanceMutex);
     if (instance != nullptr) {
@@ -47,6 +145,75 @@ void DataManager::destroyInstance() {
     }
 }
 
+User* DataManager::createUser(UserType type, const QString& username, const QString& password,
+                              const QString& email, const QString& phone, const QString& address) {
+    QMutexLocker locker(&poolMutex);
+    if (type == UserType::ADMIN)
+        return adminPool.create(username, password, email, phone, address);
+    return customerPool.create(username, password, email, phone, address);
+}
+
+Product* DataManager::createProduct(int id, const QString& name, const QString& description,
+                                    const QString& category, Money price, int stock,
+                                    const QString& seller) {
+    QMutexLocker locker(&poolMutex);
+    return productPool.create(id, name, description, category, price, stock, seller);
+}
+
+void DataManager::releaseUser(User* user) {
+    if (!user) return;
+    QMutexLocker locker(&poolMutex);
+    if (heapUsers.remove(user)) {
+        delete user;
+        return;
+    }
+    if (Admin* admin = dynamic_cast<Admin*>(user)) {
+        if (adminPool.owns(admin)) {
+            adminPool.destroy(admin);
+            return;
+        }
+    } else if (Customer* customer = dynamic_cast<Customer*>(user)) {
+        if (customerPool.owns(customer)) {
+            customerPool.destroy(customer);
+            return;
+        }
+    }
+    delete user;
+}
+
+void DataManager::releaseProduct(Product* product) {
+    if (!product) return;
+    QMutexLocker locker(&poolMutex);
+    if (heapProducts.remove(product)) {
+        delete product;
+        return;
+    }
+    if (productPool.owns(product)) {
+        productPool.destroy(product);
+        return;
+    }
+    delete product;
+}
+
+void DataManager::releaseAllUsers() {
+    QMutexLocker locker(&poolMutex);
+    for (User* user : std::as_const(heapUsers)) {
+        delete user;
+    }
+    heapUsers.clear();
+    customerPool.clear();
+    adminPool.clear();
+}
+
+void DataManager::releaseAllProducts() {
+    QMutexLocker locker(&poolMutex);
+    for (Product* product : std::as_const(heapProducts)) {
+        delete product;
+    }
+    heapProducts.clear();
+    productPool.clear();
+}
+
 QString DataManager::escapeCSV(const QString& str) {
     QString result = str;
 
@@ -80,8 +247,15 @@ bool DataManager::addUser(User* user) {
     if (users.contains(user->getUsername())) {
         return false;
     }
-    users[user->getUsername()] = user;
-    saveUsersToCSV();
+    users.insert(user->getUsername(), user);
+    {
+        QMutexLocker poolLocker(&poolMutex);
+        Admin* admin = dynamic_cast<Admin*>(user);
+        Customer* customer = dynamic_cast<Customer*>(user);
+        bool pooled = admin ? adminPool.owns(admin) : customer && customerPool.owns(customer);
+        if (!pooled) heapUsers.insert(user);
+    }
+    saveUsers();
     emit dataChanged();
     return true;
 }
@@ -98,109 +272,114 @@ bool DataManager::userExists(const QString& username) const {
 
 bool DataManager::validateLogin(const QString& username, const QString& password) const {
     QMutexLocker locker(&dataMutex);
-    if (!users.contains(username)) {
+    User* const* user = users.find(username);
+    if (!user) {
         return false;
     }
     QString hashedPass = User::hashPassword(password);
-    return users[username]->getHashedPassword() == hashedPass;
+    return (*user)->getHashedPassword() == hashedPass;
 }
 
 QVector<User*> DataManager::getAllUsers() const {
     QMutexLocker locker(&dataMutex);
-    QVector<User*> result;
-    for (auto it = users.begin(); it != users.end(); ++it) {
-        result.append(it.value());
-    }
-    return result;
+    return users.values();
 }
 
 // Product Management
 bool DataManager::addProduct(Product* product) {
     QMutexLocker locker(&dataMutex);
-    if (products.contains(product->getProductId())) {
+    if (catalog.contains(product->getProductId())) {
         return false;
     }
-    products[product->getProductId()] = product;
+    catalog.upsert(product);
+    {
+        QMutexLocker poolLocker(&poolMutex);
+        if (!productPool.owns(product)) heapProducts.insert(product);
+    }
 
     // Update nextProductId if needed
     if (product->getProductId() >= nextProductId) {
         nextProductId = product->getProductId() + 1;
     }
 
-    saveProductsToCSV();
+    ++catalogVersion;
+    saveProducts();
     emit dataChanged();
     return true;
 }
 
 Product* DataManager::getProduct(int productId) {
     QMutexLocker locker(&dataMutex);
-    return products.value(productId, nullptr);
+    return catalog.product(productId);
+}
+
+void DataManager::updateProduct(Product* product) {
+    {
+        QMutexLocker locker(&dataMutex);
+        if (catalog.product(product->getProductId()) != product) return;
+        catalog.upsert(product);
+        ++catalogVersion;
+    }
+    emit dataChanged();
 }
 
 bool DataManager::removeProduct(int productId) {
     QMutexLocker locker(&dataMutex);
-    if (!products.contains(productId)) {
+    Product* product = catalog.remove(productId);
+    if (!product) {
         return false;
     }
-    delete products[productId];
-    products.remove(productId);
-    saveProductsToCSV();
+    releaseProduct(product);
+    ++catalogVersion;
+    saveProducts();
     emit dataChanged();
     return true;
 }
 
 QVector<Product*> DataManager::getAllProducts() const {
     QMutexLocker locker(&dataMutex);
-    QVector<Product*> result;
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        result.append(it.value());
-    }
-    return result;
+    return catalog.all();
 }
 
 QVector<Product*> DataManager::getApprovedProducts() const {
     QMutexLocker locker(&dataMutex);
-    QVector<Product*> result;
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        if (it.value()->isApproved()) {
-            result.append(it.value());
-        }
-    }
-    return result;
+    return catalog.withStatus(ProductStatus::APPROVED);
 }
 
 QVector<Product*> DataManager::getPendingProducts() const {
     QMutexLocker locker(&dataMutex);
-    QVector<Product*> result;
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        if (it.value()->isPending()) {
-            result.append(it.value());
-        }
-    }
-    return result;
+    return catalog.withStatus(ProductStatus::PENDING_APPROVAL);
 }
 
 QVector<Product*> DataManager::getProductsByCategory(const QString& category) const {
     QMutexLocker locker(&dataMutex);
-    QVector<Product*> result;
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        if (it.value()->getCategory() == category && it.value()->isApproved()) {
-            result.append(it.value());
-        }
-    }
-    return result;
+    return catalog.inCategory(category, ProductStatus::APPROVED);
+}
+
+QVector<Product*> DataManager::getProductsBySeller(const QString& seller) const {
+    QMutexLocker locker(&dataMutex);
+    return catalog.bySeller(seller);
+}
+
+QVector<Product*> DataManager::getProductsInPriceRange(Money minPrice, Money maxPrice) const {
+    QMutexLocker locker(&dataMutex);
+    return catalog.inPriceRange(minPrice, maxPrice, ProductStatus::APPROVED);
+}
+
+QVector<Product*> DataManager::getProductsSortedByPrice(bool ascending) const {
+    QMutexLocker locker(&dataMutex);
+    return catalog.sortedByPrice(ProductStatus::APPROVED, ascending);
 }
 
 QVector<Product*> DataManager::searchProducts(const QString& searchTerm) const {
     QMutexLocker locker(&dataMutex);
     QVector<Product*> result;
     QString lowerTerm = searchTerm.toLower();
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        Product* p = it.value();
-        if (p->isApproved() &&
-            (p->getName().toLower().contains(lowerTerm) ||
-             p->getDescription().toLower().contains(lowerTerm) ||
-             p->getCategory().toLower().contains(lowerTerm))) {
+    // The status column narrows the set before touching any strings
+    for (Product* p : catalog.withStatus(ProductStatus::APPROVED)) {
+        if (p->getName().toLower().contains(lowerTerm) ||
+            p->getDescription().toLower().contains(lowerTerm) ||
+            p->getCategory().toLower().contains(lowerTerm)) {
             result.append(p);
         }
     }
@@ -209,11 +388,7 @@ QVector<Product*> DataManager::searchProducts(const QString& searchTerm) const {
 
 int DataManager::getPendingCount() const {
     QMutexLocker locker(&dataMutex);
-    int count = 0;
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        if (it.value()->isPending()) count++;
-    }
-    return count;
+    return catalog.countWithStatus(ProductStatus::PENDING_APPROVAL);
 }
 
 int DataManager::getNextProductId() {
@@ -221,12 +396,33 @@ int DataManager::getNextProductId() {
     return nextProductId++;
 }
 
+quint64 DataManager::getCatalogVersion() const {
+    QMutexLocker locker(&dataMutex);
+    return catalogVersion;
+}
+
+QByteArray DataManager::getCatalogTag() const {
+    QByteArray tag;
+    RowWriter(tag, '.') << catalogEpoch << qint64(getCatalogVersion());
+    return tag;
+}
+
+void DataManager::notifyCatalogChanged() {
+    {
+        QMutexLocker locker(&dataMutex);
+        ++catalogVersion;
+    }
+    emit dataChanged();
+}
+
 bool DataManager::approveProduct(int productId) {
     QMutexLocker locker(&dataMutex);
-    Product* product = getProduct(productId);
+    Product* product = catalog.product(productId);
     if (product && product->isPending()) {
         product->setStatus(ProductStatus::APPROVED);
-        saveProductsToCSV();
+        catalog.upsert(product);
+        ++catalogVersion;
+        saveProducts();
         emit productApproved(productId);
         emit dataChanged();
         return true;
@@ -236,9 +432,11 @@ bool DataManager::approveProduct(int productId) {
 
 bool DataManager::rejectProduct(int productId) {
     QMutexLocker locker(&dataMutex);
-    Product* product = getProduct(productId);
+    Product* product = catalog.product(productId);
     if (product && product->isPending()) {
-        removeProduct(productId);
+        releaseProduct(catalog.remove(productId));
+        ++catalogVersion;
+        saveProducts();
         emit productRejected(productId);
         emit dataChanged();
         return true;
@@ -272,25 +470,24 @@ bool DataManager::saveUsersToCSV() {
         return false;
     }
 
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
-
     // Header
-    stream << "username,password_hash,email,phone,address,wallet_balance,user_type\n";
+    QByteArray out = "username,password_hash,email,phone,address,wallet_balance,user_type\n";
+    out.reserve(users.size() * 160);
 
     // Data
-    for (auto it = users.begin(); it != users.end(); ++it) {
-        User* user = it.value();
-        stream << escapeCSV(user->getUsername()) << ","
-               << escapeCSV(user->getHashedPassword()) << ","
-               << escapeCSV(user->getEmail()) << ","
-               << escapeCSV(user->getPhone()) << ","
-               << escapeCSV(user->getAddress()) << ","
-               << user->getWalletBalance() << ","
-               << (user->getUserType() == UserType::ADMIN ? "admin" : "customer")
-               << "\n";
-    }
-
+    RowWriter row(out, ',');
+    for (User* user : users.values()) {
+        row << escapeCSV(user->getUsername())
+            << escapeCSV(user->getHashedPassword())
+            << escapeCSV(user->getEmail())
+            << escapeCSV(user->getPhone())
+            << escapeCSV(user->getAddress())
+            << user->getWalletBalance()
+            << (user->getUserType() == UserType::ADMIN ? "admin" : "customer");
+        row.endRow();
+    }
+
+    file.write(out);
     file.close();
     qDebug() << "Saved" << users.size() << "users to CSV";
     return true;
@@ -302,10 +499,10 @@ bool DataManager::loadUsersFromCSV() {
     // If file doesn't exist, create default admin
     if (!file.exists()) {
         qDebug() << "Users file not found, creating default admin";
-        Admin* admin = new Admin("admin", User::hashPassword("Admin123"),
+        User* admin = createUser(UserType::ADMIN, "admin", User::hashPassword("Admin123"),
                                  "admin@kalanet.com", "09123456789", "IUT");
-        admin->addFunds(10000);
-        users["admin"] = admin;
+        admin->addFunds(Money::fromUnits(10000));
+        users.insert("admin", admin);
         return saveUsersToCSV();
     }
 
@@ -314,42 +511,34 @@ bool DataManager::loadUsersFromCSV() {
         return false;
     }
 
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
+    QByteArray content = file.readAll();
 
     // Clear existing users
-    for (auto it = users.begin(); it != users.end(); ++it) {
-        delete it.value();
-    }
     users.clear();
+    releaseAllUsers();
 
     // Read header
-    QString header = stream.readLine();
+    LineReader lines(content);
+    QByteArrayView line;
+    lines.next(line);
 
     // Read data
-    while (!stream.atEnd()) {
-        QString line = stream.readLine();
-        if (line.trimmed().isEmpty()) continue;
-
-        QStringList parts = line.split(",");
-
-        if (parts.size() >= 7) {
-            QString username = unescapeCSV(parts[0]);
-            QString password = unescapeCSV(parts[1]);
-            QString email = unescapeCSV(parts[2]);
-            QString phone = unescapeCSV(parts[3]);
-            QString address = unescapeCSV(parts[4]);
-            double wallet = parts[5].toDouble();
-            QString type = parts[6];
-
-            User* user = nullptr;
-            if (type == "admin") {
-                user = new Admin(username, password, email, phone, address);
-            } else {
-                user = new Customer(username, password, email, phone, address);
-            }
+    while (lines.next(line)) {
+        FieldReader fields(line, ',', FieldReader::CsvQuotes);
+
+        if (fields.count() >= 7) {
+            QString username = unescapeCSV(fields.nextString());
+            QString password = unescapeCSV(fields.nextString());
+            QString email = unescapeCSV(fields.nextString());
+            QString phone = unescapeCSV(fields.nextString());
+            QString address = unescapeCSV(fields.nextString());
+            Money wallet = fields.nextMoney();
+            QString type = fields.nextString();
+
+            User* user = createUser(type == "admin" ? UserType::ADMIN : UserType::CUSTOMER,
+                                    username, password, email, phone, address);
             user->setWalletBalance(wallet);
-            users[username] = user;
+            users.insert(username, user);
         }
     }
 
@@ -358,10 +547,10 @@ bool DataManager::loadUsersFromCSV() {
 
     // If no users loaded, create default admin
     if (users.isEmpty()) {
-        Admin* admin = new Admin("admin", User::hashPassword("Admin123"),
+        User* admin = createUser(UserType::ADMIN, "admin", User::hashPassword("Admin123"),
                                  "admin@kalanet.com", "09123456789", "IUT");
-        admin->addFunds(10000);
-        users["admin"] = admin;
+        admin->addFunds(Money::fromUnits(10000));
+        users.insert("admin", admin);
         saveUsersToCSV();
     }
 
@@ -375,36 +564,36 @@ bool DataManager::saveProductsToCSV() {
         return false;
     }
 
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
-
     // Header
-    stream << "product_id,name,description,category,price,stock,seller,status,next_id\n";
+    QByteArray out = "product_id,name,description,category,price,stock,seller,status,next_id,image_hash\n";
+    out.reserve(catalog.size() * 160);
 
     // Data
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        Product* p = it.value();
-        QString statusStr;
+    RowWriter row(out, ',');
+    for (Product* p : catalog.all()) {
+        const char* statusStr = "pending";
         switch(p->getStatus()) {
         case ProductStatus::PENDING_APPROVAL: statusStr = "pending"; break;
         case ProductStatus::APPROVED: statusStr = "approved"; break;
         case ProductStatus::SOLD: statusStr = "sold"; break;
         }
 
-        stream << p->getProductId() << ","
-               << escapeCSV(p->getName()) << ","
-               << escapeCSV(p->getDescription()) << ","
-               << escapeCSV(p->getCategory()) << ","
-               << p->getPrice() << ","
-               << p->getStock() << ","
-               << escapeCSV(p->getSellerUsername()) << ","
-               << statusStr << ","
-               << nextProductId
-               << "\n";
+        row << p->getProductId()
+            << escapeCSV(p->getName())
+            << escapeCSV(p->getDescription())
+            << escapeCSV(p->getCategory())
+            << p->getPrice()
+            << p->getStock()
+            << escapeCSV(p->getSellerUsername())
+            << statusStr
+            << nextProductId
+            << p->getImageHash();
+        row.endRow();
     }
 
+    file.write(out);
     file.close();
-    qDebug() << "Saved" << products.size() << "products to CSV";
+    qDebug() << "Saved" << catalog.size() << "products to CSV";
     return true;
 }
 
@@ -421,186 +610,82 @@ bool DataManager::loadProductsFromCSV() {
         return false;
     }
 
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
+    QByteArray content = file.readAll();
 
     // Clear existing products
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        delete it.value();
-    }
-    products.clear();
+    catalog.clear();
+    releaseAllProducts();
 
     // Read header
-    QString header = stream.readLine();
+    LineReader lines(content);
+    QByteArrayView line;
+    lines.next(line);
 
     // Read data
-    while (!stream.atEnd()) {
-        QString line = stream.readLine();
-        if (line.trimmed().isEmpty()) continue;
-
-        QStringList parts = line.split(",");
-
-        if (parts.size() >= 8) {
-            int id = parts[0].toInt();
-            QString name = unescapeCSV(parts[1]);
-            QString desc = unescapeCSV(parts[2]);
-            QString category = unescapeCSV(parts[3]);
-            double price = parts[4].toDouble();
-            int stock = parts[5].toInt();
-            QString seller = unescapeCSV(parts[6]);
-            QString statusStr = parts[7];
-
-            if (parts.size() >= 9) {
-                nextProductId = parts[8].toInt();
+    while (lines.next(line)) {
+        FieldReader fields(line, ',', FieldReader::CsvQuotes);
+        int fieldCount = fields.count();
+
+        if (fieldCount >= 8) {
+            int id = fields.nextInt();
+            QString name = unescapeCSV(fields.nextString());
+            QString desc = unescapeCSV(fields.nextString());
+            QString category = unescapeCSV(fields.nextString());
+            Money price = fields.nextMoney();
+            int stock = fields.nextInt();
+            QString seller = unescapeCSV(fields.nextString());
+            QString statusStr = fields.nextString();
+
+            if (fieldCount >= 9) {
+                nextProductId = fields.nextInt();
             }
 
             ProductStatus status = ProductStatus::PENDING_APPROVAL;
             if (statusStr == "approved") status = ProductStatus::APPROVED;
             else if (statusStr == "sold") status = ProductStatus::SOLD;
 
-            Product* product = new Product(id, name, desc, category, price, stock, seller);
+            Product* product = createProduct(id, name, desc, category, price, stock, seller);
             product->setStatus(status);
-            products[id] = product;
+            if (fieldCount >= 10)
+                product->setImageHash(fields.nextString());
+            catalog.upsert(product);
         }
     }
 
     file.close();
-    qDebug() << "Loaded" << products.size() << "products from CSV";
+    ++catalogVersion;
+    qDebug() << "Loaded" << catalog.size() << "products from CSV";
     return true;
 }
 
 bool DataManager::saveTransactionsToCSV() {
-    QString filename = dataDir + "/transactions.csv";
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        return false;
-    }
-
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
-    stream << "username,product_id,product_name,seller,buyer,quantity,total_price,date\n";
-
-    for (auto it = users.begin(); it != users.end(); ++it) {
-        Customer* customer = dynamic_cast<Customer*>(it.value());
-        if (customer) {
-            for (const Transaction& trans : customer->getPurchaseHistory()) {
-                stream << escapeCSV(customer->getUsername()) << ","
-                       << trans.productId << ","
-                       << escapeCSV(trans.productName) << ","
-                       << escapeCSV(trans.sellerUsername) << ","
-                       << escapeCSV(trans.buyerUsername) << ","
-                       << trans.quantity << ","
-                       << trans.totalPrice << ","
-                       << trans.date.toString("yyyy-MM-dd hh:mm:ss")
-                       << "\n";
-            }
-        }
-    }
-
-    file.close();
-    return true;
+    // Rows are appended as transactions are recorded; nothing to rewrite
+    return historyStore->flush();
 }
 
 bool DataManager::loadTransactionsFromCSV() {
-    QString filename = dataDir + "/transactions.csv";
-    QFile file(filename);
-
-    if (!file.exists()) return true;
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
-
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
-
-    // Skip header
-    if (!stream.atEnd()) stream.readLine();
-
-    while (!stream.atEnd()) {
-        QString line = stream.readLine();
-        if (line.trimmed().isEmpty()) continue;
-
-        QStringList parts = line.split(",");
-
-        if (parts.size() >= 8) {
-            QString username = unescapeCSV(parts[0]);
-            Customer* customer = dynamic_cast<Customer*>(getUser(username));
-
-            if (customer) {
-                Transaction trans;
-                trans.productId = parts[1].toInt();
-                trans.productName = unescapeCSV(parts[2]);
-                trans.sellerUsername = unescapeCSV(parts[3]);
-                trans.buyerUsername = unescapeCSV(parts[4]);
-                trans.quantity = parts[5].toInt();
-                trans.totalPrice = parts[6].toDouble();
-                trans.date = QDateTime::fromString(parts[7], "yyyy-MM-dd hh:mm:ss");
-                customer->addTransaction(trans);
-            }
-        }
-    }
+    // Only the per-user offset index is built here; histories load lazily
+    return historyStore->open();
+}
 
-    file.close();
-    return true;
+void DataManager::setHistoryCacheCapacity(int transactions) {
+    historyStore->setCacheCapacity(transactions);
 }
 
 bool DataManager::saveCartToCSV() {
-    QString filename = dataDir + "/carts.csv";
-    QFile file(filename);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        return false;
-    }
-
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
-    stream << "username,product_id,quantity\n";
-
-    for (auto it = users.begin(); it != users.end(); ++it) {
-        Customer* customer = dynamic_cast<Customer*>(it.value());
-        if (customer) {
-            QMap<int, int> cart = customer->getCart();
-            for (auto cartIt = cart.begin(); cartIt != cart.end(); ++cartIt) {
-                stream << escapeCSV(customer->getUsername()) << ","
-                       << cartIt.key() << ","
-                       << cartIt.value()
-                       << "\n";
-            }
-        }
-    }
-
-    file.close();
-    return true;
+    // Changes are appended as they happen; only fold superseded rows away
+    return cartStore->compact(users.values()) && cartStore->flush();
 }
 
 bool DataManager::loadCartFromCSV() {
-    QString filename = dataDir + "/carts.csv";
-    QFile file(filename);
-
-    if (!file.exists()) return true;
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
-
-    QTextStream stream(&file);
-    stream.setEncoding(QStringConverter::Utf8);
-
-    // Skip header
-    if (!stream.atEnd()) stream.readLine();
+    QHash<QString, Cart> carts;
+    bool success = cartStore->open(carts);
 
-    while (!stream.atEnd()) {
-        QString line = stream.readLine();
-        if (line.trimmed().isEmpty()) continue;
-
-        QStringList parts = line.split(",");
-
-        if (parts.size() >= 3) {
-            QString username = unescapeCSV(parts[0]);
-            int productId = parts[1].toInt();
-            int quantity = parts[2].toInt();
-
-            Customer* customer = dynamic_cast<Customer*>(getUser(username));
-            if (customer) {
-                customer->addToCart(productId, quantity);
-            }
+    for (auto it = carts.cbegin(); it != carts.cend(); ++it) {
+        Customer* customer = dynamic_cast<Customer*>(getUser(it.key()));
+        if (customer) {
+            customer->restoreCart(it.value());
         }
     }
-
-    file.close();
-    return true;
+    return success;
 }
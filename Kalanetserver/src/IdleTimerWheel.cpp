@@ -0,0 +1,72 @@
+#include "IdleTimerWheel.h"
+
+IdleTimerWheel::IdleTimerWheel(QObject* parent)
+    : QObject(parent), m_timer(this), m_tick(0), m_timeout(0) {
+    m_timer.setInterval(1000);
+    connect(&m_timer, &QTimer::timeout, this, &IdleTimerWheel::onTick);
+}
+
+void IdleTimerWheel::setTimeout(int seconds) {
+    m_timeout = qMax(0, seconds);
+
+    // One bucket per second of timeout, plus the one being processed
+    m_buckets.clear();
+    m_buckets.resize(m_timeout + 1);
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        schedule(it.key(), it.value(), it.value().lastActive + m_timeout);
+    }
+
+    if (m_timeout > 0)
+        m_timer.start();
+    else
+        m_timer.stop();
+}
+
+void IdleTimerWheel::schedule(QObject* object, Entry& entry, quint64 deadline) {
+    if (m_buckets.isEmpty()) {
+        entry.bucket = -1;
+        return;
+    }
+    entry.bucket = static_cast<int>(deadline % m_buckets.size());
+    m_buckets[entry.bucket].append(object);
+}
+
+void IdleTimerWheel::add(QObject* object) {
+    Entry& entry = m_entries[object];
+    entry.lastActive = m_tick;
+    schedule(object, entry, m_tick + m_timeout);
+}
+
+void IdleTimerWheel::touch(QObject* object) {
+    auto it = m_entries.find(object);
+    if (it != m_entries.end())
+        it->lastActive = m_tick;
+}
+
+void IdleTimerWheel::remove(QObject* object) {
+    // Stale bucket slots are skipped when their tick comes round
+    m_entries.remove(object);
+}
+
+void IdleTimerWheel::onTick() {
+    ++m_tick;
+    if (m_buckets.isEmpty()) return;
+
+    int index = static_cast<int>(m_tick % m_buckets.size());
+    QVector<QObject*> due;
+    due.swap(m_buckets[index]);
+
+    for (QObject* object : due) {
+        auto it = m_entries.find(object);
+        // Removed, or rescheduled into another bucket since
+        if (it == m_entries.end() || it->bucket != index) continue;
+
+        quint64 deadline = it->lastActive + m_timeout;
+        if (deadline <= m_tick) {
+            m_entries.erase(it);
+            emit expired(object);
+        } else {
+            schedule(object, *it, deadline);
+        }
+    }
+}
@@ -0,0 +1,162 @@
+#include "ImageStore.h"
+#include "Product.h"
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QSaveFile>
+
+namespace {
+
+// Largest image accepted as a blob; bigger uploads are scaled down
+const int kMaxDimension = 400;
+
+struct SizeInfo {
+    const char* name;
+    int dimension;
+};
+
+const SizeInfo kSizes[] = {
+    {"thumb", 64},
+    {"medium", 200},
+    {"full", kMaxDimension},
+};
+
+QByteArray readFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+// Written to a temporary file and renamed, so a blob is never half there
+bool writeFile(const QString& path, const QByteArray& data) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit();
+}
+
+QByteArray encodeJpeg(const QImage& image) {
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "JPEG", 85);
+    return bytes;
+}
+
+}
+
+ImageStore::ImageStore(const QString& directory)
+    : m_directory(directory), m_cache(32 * 1024) {
+    QDir().mkpath(m_directory);
+}
+
+QString ImageStore::put(const QByteArray& data) {
+    QImage image;
+    if (data.isEmpty() || !image.loadFromData(data)) return QString();
+
+    // Oversized uploads are stored at the largest size we serve
+    QByteArray blob = data;
+    if (image.width() > kMaxDimension || image.height() > kMaxDimension)
+        blob = encodeJpeg(Product::resizeImage(image, kMaxDimension, kMaxDimension));
+
+    QString hash = hashOf(blob);
+    QString path = pathFor(hash);
+    if (QFile::exists(path))
+        return hash; // same content, already stored
+
+    if (!writeFile(path, blob)) {
+        qDebug() << "Failed to write image blob:" << path;
+        return QString();
+    }
+    return hash;
+}
+
+bool ImageStore::contains(const QString& hash) const {
+    return isValidHash(hash) && QFile::exists(pathFor(hash));
+}
+
+ImageStore::Image ImageStore::image(const QString& hash, Size size) {
+    if (!isValidHash(hash)) return Image();
+
+    QString key = hash + "." + sizeName(size);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (Image* cached = m_cache.object(key))
+            return *cached;
+    }
+
+    Image result;
+    if (size == Full) {
+        // Content-addressed: the hash already identifies these bytes
+        result.data = readFile(pathFor(hash));
+        result.etag = hash;
+    } else {
+        QString path = variantPath(hash, size);
+        result.data = readFile(path);
+        if (result.data.isEmpty()) {
+            result.data = scale(readFile(pathFor(hash)), size);
+            if (!result.data.isEmpty() && !writeFile(path, result.data))
+                qDebug() << "Failed to write image variant:" << path;
+        }
+        result.etag = hashOf(result.data);
+    }
+    if (result.isNull()) return Image();
+
+    QMutexLocker locker(&m_mutex);
+    m_cache.insert(key, new Image(result), qMax(1, int(result.data.size() / 1024)));
+    return result;
+}
+
+void ImageStore::setCacheCapacity(int kilobytes) {
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(qMax(0, kilobytes));
+}
+
+QString ImageStore::pathFor(const QString& hash) const {
+    return m_directory + "/" + hash.left(2) + "/" + hash;
+}
+
+QString ImageStore::variantPath(const QString& hash, Size size) const {
+    return pathFor(hash) + "." + sizeName(size);
+}
+
+QByteArray ImageStore::scale(const QByteArray& source, Size size) const {
+    QImage image;
+    if (source.isEmpty() || !image.loadFromData(source)) return QByteArray();
+
+    int dimension = kSizes[size].dimension;
+    if (image.width() <= dimension && image.height() <= dimension)
+        return source; // already small enough
+    return encodeJpeg(Product::resizeImage(image, dimension, dimension));
+}
+
+QString ImageStore::hashOf(const QByteArray& data) {
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+bool ImageStore::isValidHash(const QString& hash) {
+    if (hash.size() != 64) return false;
+    for (QChar c : hash) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+            return false;
+    }
+    return true;
+}
+
+bool ImageStore::parseSize(QStringView text, Size& size) {
+    for (int i = 0; i <= Full; ++i) {
+        if (text == QLatin1String(kSizes[i].name)) {
+            size = Size(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ImageStore::sizeName(Size size) {
+    return kSizes[size].name;
+}
@@ -276,12 +276,7 @@ void LoginDialog::onSignupClicked() {
 
     QString hashedPass = User::hashPassword(password);
 
-    User* newUser = nullptr;
-    if (type == UserType::ADMIN) {
-        newUser = new Admin(username, hashedPass, email, phone, address);
-    } else {
-        newUser = new Customer(username, hashedPass, email, phone, address);
-    }
+    User* newUser = dm->createUser(type, username, hashedPass, email, phone, address);
 
     if (dm->addUser(newUser)) {
         QMessageBox::information(this, "Success", "Account created successfully! Please login.");
@@ -289,7 +284,7 @@ void LoginDialog::onSignupClicked() {
         clearFields();
     } else {
         signupErrorLabel->setText("Failed to create account");
-        delete newUser;
+        dm->releaseUser(newUser);
     }
 }
 
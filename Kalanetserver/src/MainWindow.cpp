@@ -1,6 +1,7 @@
 #include "MainWindow.h"
 #include "DataManager.h"
 #include "Product.h"
+#include "Symbols.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -497,7 +498,7 @@ void MainWindow::setupMyProductsTab() {
 void MainWindow::updateProfileInfo() {
     usernameLabel->setText(currentUser->getUsername());
     userTypeLabel->setText(currentUser->getUserTypeString());
-    walletLabel->setText("$" + QString::number(currentUser->getWalletBalance(), 'f', 2));
+    walletLabel->setText("$" + currentUser->getWalletBalance().toString());
 }
 
 void MainWindow::onUpdateProfile() {
@@ -515,7 +516,7 @@ void MainWindow::onAddFunds() {
                                              "Enter amount to add:",
                                              100, 1, 10000, 2, &ok);
     if (ok && amount > 0) {
-        currentUser->addFunds(amount);
+        currentUser->addFunds(Money::fromDouble(amount));
         DataManager::getInstance()->saveUsers();
         updateProfileInfo();
         refreshWallet();
@@ -540,7 +541,7 @@ void MainWindow::refreshProductList() {
         productsTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
         productsTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
         productsTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        productsTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
+        productsTable->setItem(i, 3, new QTableWidgetItem("$" + p->getPrice().toString()));
         productsTable->setItem(i, 4, new QTableWidgetItem(QString::number(p->getStock())));
         productsTable->setItem(i, 5, new QTableWidgetItem(p->getSellerUsername()));
     }
@@ -562,9 +563,10 @@ void MainWindow::onSearchProducts() {
     // Apply category filter
     QString category = categoryCombo->currentText();
     if (category != "All Categories") {
+        int categoryId = symbols().find(category);
         QVector<Product*> filtered;
         for (Product* p : products) {
-            if (p->getCategory() == category) {
+            if (p->getCategoryId() == categoryId) {
                 filtered.append(p);
             }
         }
@@ -578,7 +580,7 @@ void MainWindow::onSearchProducts() {
         productsTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
         productsTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
         productsTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        productsTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
+        productsTable->setItem(i, 3, new QTableWidgetItem("$" + p->getPrice().toString()));
         productsTable->setItem(i, 4, new QTableWidgetItem(QString::number(p->getStock())));
         productsTable->setItem(i, 5, new QTableWidgetItem(p->getSellerUsername()));
     }
@@ -618,7 +620,6 @@ void MainWindow::onAddToCart() {
     Customer* customer = dynamic_cast<Customer*>(currentUser);
     if (customer) {
         customer->addToCart(productId, quantity);
-        dm->saveUsers();
         refreshCart();
         showSuccess("Added " + QString::number(quantity) + " x " + product->getName() + " to cart");
     }
@@ -646,7 +647,7 @@ void MainWindow::onViewProductDetails() {
                             .arg(product->getName())
                             .arg(product->getDescription())
                             .arg(product->getCategory())
-                            .arg(product->getPrice(), 0, 'f', 2)
+                            .arg(product->getPrice().toString())
                             .arg(product->getStock())
                             .arg(product->getSellerUsername())
                             .arg(product->getStatusString());
@@ -661,27 +662,28 @@ void MainWindow::refreshCart() {
     if (!customer) return;
 
     DataManager* dm = DataManager::getInstance();
-    const QMap<int, int>& cart = customer->getCart();
+    const Cart& cart = customer->getCart();
 
     cartTable->setRowCount(cart.size());
-    double total = 0;
+    Money total;
 
     int row = 0;
-    for (auto it = cart.begin(); it != cart.end(); ++it, ++row) {
-        Product* product = dm->getProduct(it.key());
+    for (const CartItem& item : cart) {
+        Product* product = dm->getProduct(item.productId);
         if (product) {
-            double itemTotal = product->getPrice() * it.value();
+            Money itemTotal = product->getPrice() * item.quantity;
             total += itemTotal;
 
             cartTable->setItem(row, 0, new QTableWidgetItem(QString::number(product->getProductId())));
             cartTable->setItem(row, 1, new QTableWidgetItem(product->getName()));
-            cartTable->setItem(row, 2, new QTableWidgetItem("$" + QString::number(product->getPrice(), 'f', 2)));
-            cartTable->setItem(row, 3, new QTableWidgetItem(QString::number(it.value())));
-            cartTable->setItem(row, 4, new QTableWidgetItem("$" + QString::number(itemTotal, 'f', 2)));
+            cartTable->setItem(row, 2, new QTableWidgetItem("$" + product->getPrice().toString()));
+            cartTable->setItem(row, 3, new QTableWidgetItem(QString::number(item.quantity)));
+            cartTable->setItem(row, 4, new QTableWidgetItem("$" + itemTotal.toString()));
         }
+        ++row;
     }
 
-    cartTotalLabel->setText("Total: $" + QString::number(total, 'f', 2));
+    cartTotalLabel->setText("Total: $" + total.toString());
     cartTable->resizeColumnsToContents();
 }
 
@@ -697,7 +699,6 @@ void MainWindow::onRemoveFromCart() {
     Customer* customer = dynamic_cast<Customer*>(currentUser);
     if (customer) {
         customer->removeFromCart(productId);
-        DataManager::getInstance()->saveUsers();
         refreshCart();
     }
 }
@@ -706,7 +707,6 @@ void MainWindow::onClearCart() {
     Customer* customer = dynamic_cast<Customer*>(currentUser);
     if (customer) {
         customer->clearCart();
-        DataManager::getInstance()->saveUsers();
         refreshCart();
         showSuccess("Cart cleared");
     }
@@ -724,11 +724,11 @@ void MainWindow::onCheckout() {
     DataManager* dm = DataManager::getInstance();
 
     // Calculate total
-    double total = 0;
-    for (auto it = customer->getCart().begin(); it != customer->getCart().end(); ++it) {
-        Product* product = dm->getProduct(it.key());
+    Money total;
+    for (const CartItem& item : customer->getCart()) {
+        Product* product = dm->getProduct(item.productId);
         if (product) {
-            total += product->getPrice() * it.value();
+            total += product->getPrice() * item.quantity;
         }
     }
 
@@ -739,18 +739,18 @@ void MainWindow::onCheckout() {
 
     // Confirm purchase
     int reply = QMessageBox::question(this, "Confirm Purchase",
-                                       "Total: $" + QString::number(total, 'f', 2) + 
+                                       "Total: $" + total.toString() + 
                                        "\nProceed with checkout?",
                                        QMessageBox::Yes | QMessageBox::No);
 
     if (reply != QMessageBox::Yes) return;
 
     // Process purchase
-    for (auto it = customer->getCart().begin(); it != customer->getCart().end(); ++it) {
-        Product* product = dm->getProduct(it.key());
+    for (const CartItem& item : customer->getCart()) {
+        Product* product = dm->getProduct(item.productId);
         if (product) {
-            int quantity = it.value();
-            double itemTotal = product->getPrice() * quantity;
+            int quantity = item.quantity;
+            Money itemTotal = product->getPrice() * quantity;
 
             // Deduct from buyer
             customer->deductFunds(itemTotal);
@@ -763,8 +763,9 @@ void MainWindow::onCheckout() {
 
             // Reduce stock
             product->purchase(quantity);
+            dm->updateProduct(product);
 
-            // Record transaction for buyer
+            // Record transaction; it is indexed as the seller's sale too
             Transaction trans;
             trans.productId = product->getProductId();
             trans.productName = product->getName();
@@ -774,13 +775,6 @@ void MainWindow::onCheckout() {
             trans.totalPrice = itemTotal;
             trans.date = QDateTime::currentDateTime();
             customer->addTransaction(trans);
-
-            // Record transaction for seller if they are a customer
-            Customer* sellerCustomer = dynamic_cast<Customer*>(seller);
-            if (sellerCustomer) {
-                Transaction sellerTrans = trans;
-                sellerCustomer->addTransaction(sellerTrans);
-            }
         }
     }
 
@@ -796,12 +790,12 @@ void MainWindow::onCheckout() {
     updateProfileInfo();
     refreshProductList();
 
-    showSuccess("Purchase completed successfully!\n$" + QString::number(total, 'f', 2) + " deducted from your wallet.");
+    showSuccess("Purchase completed successfully!\n$" + total.toString() + " deducted from your wallet.");
 }
 
 // Wallet Tab Slots
 void MainWindow::refreshWallet() {
-    walletBalanceLabel->setText("$" + QString::number(currentUser->getWalletBalance(), 'f', 2));
+    walletBalanceLabel->setText("$" + currentUser->getWalletBalance().toString());
     refreshTransactionHistory();
 }
 
@@ -809,7 +803,7 @@ void MainWindow::refreshTransactionHistory() {
     Customer* customer = dynamic_cast<Customer*>(currentUser);
     if (!customer) return;
 
-    const QVector<Transaction>& history = customer->getPurchaseHistory();
+    const QVector<Transaction> history = customer->getPurchaseHistory();
     transactionTable->setRowCount(history.size());
 
     for (int i = 0; i < history.size(); ++i) {
@@ -819,7 +813,7 @@ void MainWindow::refreshTransactionHistory() {
         transactionTable->setItem(i, 2, new QTableWidgetItem(trans.sellerUsername));
         transactionTable->setItem(i, 3, new QTableWidgetItem(trans.buyerUsername));
         transactionTable->setItem(i, 4, new QTableWidgetItem(QString::number(trans.quantity)));
-        transactionTable->setItem(i, 5, new QTableWidgetItem("$" + QString::number(trans.totalPrice, 'f', 2)));
+        transactionTable->setItem(i, 5, new QTableWidgetItem("$" + trans.totalPrice.toString()));
     }
 
     transactionTable->resizeColumnsToContents();
@@ -828,7 +822,7 @@ void MainWindow::refreshTransactionHistory() {
 void MainWindow::onDepositFunds() {
     double amount = depositSpinBox->value();
     if (amount > 0) {
-        currentUser->addFunds(amount);
+        currentUser->addFunds(Money::fromDouble(amount));
         DataManager::getInstance()->saveUsers();
         refreshWallet();
         updateProfileInfo();
@@ -840,9 +834,9 @@ void MainWindow::onWithdrawFunds() {
     bool ok;
     double amount = QInputDialog::getDouble(this, "Withdraw Funds",
                                              "Enter amount to withdraw:",
-                                             0, 0, currentUser->getWalletBalance(), 2, &ok);
+                                             0, 0, currentUser->getWalletBalance().toDouble(), 2, &ok);
     if (ok && amount > 0) {
-        if (currentUser->deductFunds(amount)) {
+        if (currentUser->deductFunds(Money::fromDouble(amount))) {
             DataManager::getInstance()->saveUsers();
             refreshWallet();
             updateProfileInfo();
@@ -863,7 +857,7 @@ void MainWindow::refreshAdminProducts() {
         adminProductsTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
         adminProductsTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
         adminProductsTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        adminProductsTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
+        adminProductsTable->setItem(i, 3, new QTableWidgetItem("$" + p->getPrice().toString()));
         adminProductsTable->setItem(i, 4, new QTableWidgetItem(QString::number(p->getStock())));
         adminProductsTable->setItem(i, 5, new QTableWidgetItem(p->getStatusString()));
         adminProductsTable->setItem(i, 6, new QTableWidgetItem(p->getSellerUsername()));
@@ -883,7 +877,7 @@ void MainWindow::refreshPendingProducts() {
         pendingTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
         pendingTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
         pendingTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-        pendingTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
+        pendingTable->setItem(i, 3, new QTableWidgetItem("$" + p->getPrice().toString()));
         pendingTable->setItem(i, 4, new QTableWidgetItem(p->getSellerUsername()));
         pendingTable->setItem(i, 5, new QTableWidgetItem(p->getRegistrationDate().toString("yyyy-MM-dd")));
     }
@@ -933,12 +927,12 @@ void MainWindow::onAddProduct() {
         DataManager* dm = DataManager::getInstance();
         int productId = dm->getNextProductId();
 
-        Product* product = new Product(
+        Product* product = dm->createProduct(
             productId,
             nameEdit->text(),
             descEdit->toPlainText(),
             catCombo->currentText(),
-            priceSpin->value(),
+            Money::fromDouble(priceSpin->value()),
             stockSpin->value(),
             currentUser->getUsername()
         );
@@ -1002,12 +996,12 @@ void MainWindow::onRegisterProduct() {
         DataManager* dm = DataManager::getInstance();
         int productId = dm->getNextProductId();
 
-        Product* product = new Product(
+        Product* product = dm->createProduct(
             productId,
             nameEdit->text(),
             descEdit->toPlainText(),
             catCombo->currentText(),
-            priceSpin->value(),
+            Money::fromDouble(priceSpin->value()),
             stockSpin->value(),
             currentUser->getUsername()
         );
@@ -1060,7 +1054,7 @@ void MainWindow::onEditProduct() {
     priceSpin->setRange(0.01, 100000);
     priceSpin->setPrefix("$");
     priceSpin->setDecimals(2);
-    priceSpin->setValue(product->getPrice());
+    priceSpin->setValue(product->getPrice().toDouble());
     QSpinBox* stockSpin = new QSpinBox(&dialog);
     stockSpin->setRange(0, 10000);
     stockSpin->setValue(product->getStock());
@@ -1082,8 +1076,9 @@ void MainWindow::onEditProduct() {
         product->setName(nameEdit->text());
         product->setDescription(descEdit->toPlainText());
         product->setCategory(catCombo->currentText());
-        product->setPrice(priceSpin->value());
+        product->setPrice(Money::fromDouble(priceSpin->value()));
         product->setStock(stockSpin->value());
+        dm->updateProduct(product);
 
         dm->saveProducts();
         refreshAdminProducts();
@@ -1174,7 +1169,7 @@ void MainWindow::refreshMyProducts() {
             myProductsTable->setItem(i, 0, new QTableWidgetItem(QString::number(p->getProductId())));
             myProductsTable->setItem(i, 1, new QTableWidgetItem(p->getName()));
             myProductsTable->setItem(i, 2, new QTableWidgetItem(p->getCategory()));
-            myProductsTable->setItem(i, 3, new QTableWidgetItem("$" + QString::number(p->getPrice(), 'f', 2)));
+            myProductsTable->setItem(i, 3, new QTableWidgetItem("$" + p->getPrice().toString()));
             myProductsTable->setItem(i, 4, new QTableWidgetItem(QString::number(p->getStock())));
             myProductsTable->setItem(i, 5, new QTableWidgetItem(p->getStatusString()));
         }
@@ -1229,12 +1224,12 @@ void MainWindow::onRegisterNewProduct() {
         DataManager* dm = DataManager::getInstance();
         int productId = dm->getNextProductId();
 
-        Product* product = new Product(
+        Product* product = dm->createProduct(
             productId,
             nameEdit->text(),
             descEdit->toPlainText(),
             catCombo->currentText(),
-            priceSpin->value(),
+            Money::fromDouble(priceSpin->value()),
             stockSpin->value(),
             currentUser->getUsername()
         );
@@ -1,20 +1,34 @@
 #include "Product.h"
+#include "Symbols.h"
+#include <QImage>
 
 Product::Product() 
-    : productId(0), price(0.0), stock(0), 
+    : productId(0), categoryId(-1), price(), stock(0), sellerId(-1),
       status(ProductStatus::PENDING_APPROVAL) {
     registrationDate = QDateTime::currentDateTime();
 }
 
 Product::Product(int id, const QString& name, const QString& description, 
-                 const QString& category, double price, int stock, 
+                 const QString& category, Money price, int stock, 
                  const QString& seller)
     : productId(id), name(name), description(description), 
-      category(category), price(price), stock(stock), 
-      sellerUsername(seller), status(ProductStatus::PENDING_APPROVAL) {
+      price(price), stock(stock), status(ProductStatus::PENDING_APPROVAL) {
+    setCategory(category);
+    setSellerUsername(seller);
     registrationDate = QDateTime::currentDateTime();
 }
 
+// The names are resolved once here so getters take no pool lock
+void Product::setCategory(const QString& cat) {
+    categoryId = symbols().intern(cat);
+    category = symbols().string(categoryId);
+}
+
+void Product::setSellerUsername(const QString& seller) {
+    sellerId = symbols().intern(seller);
+    sellerUsername = symbols().string(sellerId);
+}
+
 QString Product::getStatusString() const {
     switch(status) {
         case ProductStatus::PENDING_APPROVAL:
@@ -39,16 +53,35 @@ bool Product::purchase(int quantity) {
     return true;
 }
 
+QImage Product::resizeImage(const QImage& source, int maxWidth, int maxHeight) {
+    if (source.isNull()) {
+        return QImage();
+    }
+
+    // Only resize if larger than max dimensions
+    if (source.width() <= maxWidth && source.height() <= maxHeight) {
+        return source;
+    }
+
+    QSize newSize = source.size();
+    newSize.scale(maxWidth, maxHeight, Qt::KeepAspectRatio);
+    return source.scaled(newSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+
 void Product::saveToStream(QDataStream& stream) const {
-    stream << productId << name << description << category 
-           << price << stock << sellerUsername 
+    stream << productId << name << description << getCategory() 
+           << price << stock << getSellerUsername() 
            << static_cast<int>(status) << registrationDate << imagePath;
 }
 
 void Product::loadFromStream(QDataStream& stream) {
     int statusInt;
+    QString category;
+    QString sellerUsername;
     stream >> productId >> name >> description >> category 
            >> price >> stock >> sellerUsername 
            >> statusInt >> registrationDate >> imagePath;
     status = static_cast<ProductStatus>(statusInt);
+    setCategory(category);
+    setSellerUsername(sellerUsername);
 }
@@ -0,0 +1,218 @@
+#include "ProductCatalog.h"
+#include "Symbols.h"
+#include <algorithm>
+
+namespace {
+// Ids up to twice the product count plus this stay in the direct array
+const int kDenseSlack = 1 << 16;
+}
+
+ProductCatalog::ProductCatalog() {
+}
+
+void ProductCatalog::clear() {
+    m_slotById.clear();
+    m_sparseSlots.clear();
+    m_ids.clear();
+    m_prices.clear();
+    m_stock.clear();
+    m_status.clear();
+    m_categoryIds.clear();
+    m_sellerIds.clear();
+    m_products.clear();
+}
+
+int ProductCatalog::slotOf(int productId) const {
+    if (productId < 0) return -1;
+    if (productId < m_slotById.size()) return m_slotById[productId];
+    return m_sparseSlots.value(productId, -1);
+}
+
+void ProductCatalog::setSlot(int productId, int slot) {
+    if (productId < m_slotById.size())
+        m_slotById[productId] = slot;
+    else
+        m_sparseSlots[productId] = slot;
+}
+
+void ProductCatalog::writeRow(int slot, Product* product) {
+    m_ids[slot] = product->getProductId();
+    m_prices[slot] = product->getPrice().cents();
+    m_stock[slot] = product->getStock();
+    m_status[slot] = static_cast<quint8>(product->getStatus());
+    m_categoryIds[slot] = product->getCategoryId();
+    m_sellerIds[slot] = product->getSellerId();
+    m_products[slot] = product;
+}
+
+void ProductCatalog::reindexFrom(int slot) {
+    for (int i = slot; i < m_ids.size(); ++i)
+        setSlot(m_ids[i], i);
+}
+
+void ProductCatalog::upsert(Product* product) {
+    int id = product->getProductId();
+    if (id < 0) return;
+
+    int slot = slotOf(id);
+    if (slot >= 0) {
+        writeRow(slot, product);
+        return;
+    }
+
+    if (id >= m_slotById.size() && id < 2 * m_ids.size() + kDenseSlack) {
+        m_slotById.resize(id + 1, -1);
+        // Sparse ids now inside the array move into it
+        for (auto it = m_sparseSlots.begin(); it != m_sparseSlots.end();) {
+            if (it.key() < m_slotById.size()) {
+                m_slotById[it.key()] = it.value();
+                it = m_sparseSlots.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Ids are handed out increasingly, so this is almost always an append
+    if (m_ids.isEmpty() || id > m_ids.last()) {
+        slot = m_ids.size();
+    } else {
+        slot = int(std::lower_bound(m_ids.cbegin(), m_ids.cend(), id) - m_ids.cbegin());
+    }
+    m_ids.insert(slot, id);
+    m_prices.insert(slot, 0);
+    m_stock.insert(slot, 0);
+    m_status.insert(slot, 0);
+    m_categoryIds.insert(slot, -1);
+    m_sellerIds.insert(slot, -1);
+    m_products.insert(slot, nullptr);
+    writeRow(slot, product);
+    reindexFrom(slot);
+}
+
+Product* ProductCatalog::remove(int productId) {
+    int slot = slotOf(productId);
+    if (slot < 0) return nullptr;
+
+    Product* product = m_products[slot];
+    m_ids.remove(slot);
+    m_prices.remove(slot);
+    m_stock.remove(slot);
+    m_status.remove(slot);
+    m_categoryIds.remove(slot);
+    m_sellerIds.remove(slot);
+    m_products.remove(slot);
+    if (productId < m_slotById.size())
+        m_slotById[productId] = -1;
+    else
+        m_sparseSlots.remove(productId);
+    reindexFrom(slot);
+    return product;
+}
+
+Product* ProductCatalog::product(int productId) const {
+    int slot = slotOf(productId);
+    return slot < 0 ? nullptr : m_products[slot];
+}
+
+QVector<Product*> ProductCatalog::materialize(const QVector<int>& slots) const {
+    QVector<Product*> result;
+    result.reserve(slots.size());
+    for (int slot : slots)
+        result.append(m_products[slot]);
+    return result;
+}
+
+QVector<Product*> ProductCatalog::all() const {
+    return m_products;
+}
+
+QVector<Product*> ProductCatalog::withStatus(ProductStatus status) const {
+    const quint8 wanted = static_cast<quint8>(status);
+    const quint8* st = m_status.constData();
+    const int n = m_status.size();
+
+    QVector<int> slots;
+    for (int i = 0; i < n; ++i) {
+        if (st[i] == wanted) slots.append(i);
+    }
+    return materialize(slots);
+}
+
+int ProductCatalog::countWithStatus(ProductStatus status) const {
+    const quint8 wanted = static_cast<quint8>(status);
+    const quint8* st = m_status.constData();
+    const int n = m_status.size();
+
+    int count = 0;
+    for (int i = 0; i < n; ++i)
+        count += (st[i] == wanted);
+    return count;
+}
+
+QVector<Product*> ProductCatalog::inCategory(const QString& category, ProductStatus status) const {
+    const int categoryId = symbols().find(category);
+    if (categoryId < 0) return QVector<Product*>();
+
+    const quint8 wanted = static_cast<quint8>(status);
+    const quint8* st = m_status.constData();
+    const int* cat = m_categoryIds.constData();
+    const int n = m_status.size();
+
+    QVector<int> slots;
+    for (int i = 0; i < n; ++i) {
+        if ((cat[i] == categoryId) & (st[i] == wanted)) slots.append(i);
+    }
+    return materialize(slots);
+}
+
+QVector<Product*> ProductCatalog::bySeller(const QString& seller) const {
+    const int sellerId = symbols().find(seller);
+    if (sellerId < 0) return QVector<Product*>();
+
+    const int* sel = m_sellerIds.constData();
+    const int n = m_sellerIds.size();
+
+    QVector<int> slots;
+    for (int i = 0; i < n; ++i) {
+        if (sel[i] == sellerId) slots.append(i);
+    }
+    return materialize(slots);
+}
+
+QVector<Product*> ProductCatalog::inPriceRange(Money minPrice, Money maxPrice,
+                                               ProductStatus status) const {
+    const quint8 wanted = static_cast<quint8>(status);
+    const quint8* st = m_status.constData();
+    const qint64* price = m_prices.constData();
+    const qint64 lo = minPrice.cents();
+    const qint64 hi = maxPrice.cents();
+    const int n = m_status.size();
+
+    QVector<int> slots;
+    for (int i = 0; i < n; ++i) {
+        // Non-short-circuit ands keep the predicate branch-free
+        if ((st[i] == wanted) & (price[i] >= lo) & (price[i] <= hi))
+            slots.append(i);
+    }
+    return materialize(slots);
+}
+
+QVector<Product*> ProductCatalog::sortedByPrice(ProductStatus status, bool ascending) const {
+    const quint8 wanted = static_cast<quint8>(status);
+    const quint8* st = m_status.constData();
+    const qint64* price = m_prices.constData();
+    const int n = m_status.size();
+
+    QVector<int> slots;
+    for (int i = 0; i < n; ++i) {
+        if (st[i] == wanted) slots.append(i);
+    }
+    // Slots are in id order, so comparing slots breaks ties by id
+    std::sort(slots.begin(), slots.end(), [price, ascending](int a, int b) {
+        if (price[a] != price[b])
+            return ascending ? price[a] < price[b] : price[a] > price[b];
+        return a < b;
+    });
+    return materialize(slots);
+}
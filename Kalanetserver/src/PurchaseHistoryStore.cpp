@@ -0,0 +1,286 @@
+#include "PurchaseHistoryStore.h"
+#include "DataManager.h"
+#include "SalesLedger.h"
+#include "TextFormat.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const char* const kHeader = "username,product_id,product_name,seller,buyer,quantity,total_price,date\n";
+const char* const kDateFormat = "yyyy-MM-dd hh:mm:ss";
+}
+
+PurchaseHistoryStore::PurchaseHistoryStore(const QString& path)
+    : m_file(path), m_cache(10000), m_ledger(nullptr) {
+}
+
+void PurchaseHistoryStore::setSalesLedger(SalesLedger* ledger) {
+    QMutexLocker locker(&m_mutex);
+    m_ledger = ledger;
+}
+
+bool PurchaseHistoryStore::open() {
+    QMutexLocker locker(&m_mutex);
+    if (m_file.isOpen()) m_file.close();
+    m_index.clear();
+    m_cache.clear();
+    if (m_ledger) m_ledger->clear();
+
+    // Binary mode so positions are the raw byte offsets we seek back to
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qDebug() << "Failed to open transactions file:" << m_file.fileName();
+        return false;
+    }
+    if (m_file.size() == 0) {
+        m_file.write(kHeader);
+        return m_file.flush();
+    }
+
+    // Skip header
+    m_file.readLine();
+
+    int rows = 0;
+    while (!m_file.atEnd()) {
+        qint64 offset = m_file.pos();
+        QByteArray line = m_file.readLine();
+        Transaction trans;
+        QString username;
+        qint64 time = 0;
+        if (!parseRow(line, trans, &username, &time)) continue;
+
+        // Older files also hold a copy of each sale under the seller's name;
+        // the buyer's row is indexed for both, so the copy is skipped
+        if (username != trans.buyerUsername) continue;
+
+        index(username, {offset, time, rolesFor(username, trans)});
+        if (trans.sellerUsername != username)
+            index(trans.sellerUsername, {offset, time, AsSeller});
+        if (m_ledger) m_ledger->record(trans);
+        ++rows;
+    }
+
+    // Appends must start on a fresh line
+    m_file.seek(m_file.size() - 1);
+    char last = 0;
+    m_file.getChar(&last);
+    if (last != '\n') {
+        m_file.write("\n");
+        m_file.flush();
+    }
+
+    qDebug() << "Indexed" << rows << "transactions for" << m_index.size() << "users";
+    return true;
+}
+
+void PurchaseHistoryStore::close() {
+    QMutexLocker locker(&m_mutex);
+    m_file.close();
+    m_index.clear();
+    m_cache.clear();
+}
+
+QVector<Transaction> PurchaseHistoryStore::history(const QString& username) {
+    QMutexLocker locker(&m_mutex);
+    if (QVector<Transaction>* cached = m_cache.object(username))
+        return *cached;
+
+    auto it = m_index.constFind(username);
+    if (it == m_index.constEnd() || !m_file.isOpen())
+        return QVector<Transaction>();
+
+    // Date order is append order, so this is normally one forward pass
+    QVector<Transaction> rows;
+    rows.reserve(it->size());
+    for (const IndexEntry& entry : *it) {
+        Transaction trans;
+        if (!m_file.seek(entry.offset) || !parseRow(m_file.readLine(), trans)) break;
+        rows.append(trans);
+    }
+    cache(username, rows);
+    return rows;
+}
+
+PurchaseHistoryStore::Page PurchaseHistoryStore::page(const QString& username, const Query& query) {
+    Page result;
+    if (query.limit <= 0) return result;
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_index.constFind(username);
+    if (it == m_index.constEnd() || !m_file.isOpen())
+        return result;
+    const QVector<IndexEntry>& entries = *it;
+
+    // Narrow to the date range with two binary searches
+    auto first = entries.cbegin();
+    auto last = entries.cend();
+    if (query.from.isValid()) {
+        qint64 from = timeKey(query.from);
+        first = std::lower_bound(first, last, from,
+                                 [](const IndexEntry& e, qint64 t) { return e.time < t; });
+    }
+    if (query.to.isValid()) {
+        qint64 to = timeKey(query.to);
+        last = std::upper_bound(first, last, to,
+                                [](qint64 t, const IndexEntry& e) { return t < e.time; });
+    }
+    int begin = int(first - entries.cbegin());
+    int end = int(last - entries.cbegin());
+    if (query.cursor >= 0)
+        end = qMin(end, query.cursor);
+
+    // A cached history lines up with the index; otherwise read just this page
+    const QVector<Transaction>* cached = m_cache.object(username);
+    if (cached && cached->size() != entries.size())
+        cached = nullptr;
+
+    for (int i = end - 1; i >= begin; --i) {
+        if (!(entries[i].roles & query.roles)) continue;
+        if (result.rows.size() == query.limit) {
+            result.nextCursor = i + 1;
+            break;
+        }
+        if (cached) {
+            result.rows.append(cached->at(i));
+        } else {
+            Transaction trans;
+            if (!m_file.seek(entries[i].offset) || !parseRow(m_file.readLine(), trans)) break;
+            result.rows.append(trans);
+        }
+    }
+    return result;
+}
+
+int PurchaseHistoryStore::count(const QString& username) const {
+    QMutexLocker locker(&m_mutex);
+    return m_index.value(username).size();
+}
+
+bool PurchaseHistoryStore::append(const QString& username, const Transaction& trans) {
+    QByteArray out;
+    RowWriter row(out, ',');
+    row << DataManager::escapeCSV(username)
+        << trans.productId
+        << DataManager::escapeCSV(trans.productName)
+        << DataManager::escapeCSV(trans.sellerUsername)
+        << DataManager::escapeCSV(trans.buyerUsername)
+        << trans.quantity
+        << trans.totalPrice
+        << trans.date.toString(kDateFormat);
+    row.endRow();
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_file.isOpen() || !m_file.seek(m_file.size()))
+        return false;
+    qint64 offset = m_file.pos();
+    if (m_file.write(out) != out.size() || !m_file.flush()) {
+        qDebug() << "Failed to append transaction for" << username;
+        return false;
+    }
+    qint64 time = timeKey(trans.date);
+    index(username, {offset, time, rolesFor(username, trans)}, &trans);
+    if (trans.sellerUsername != username)
+        index(trans.sellerUsername, {offset, time, AsSeller}, &trans);
+    if (m_ledger) m_ledger->record(trans);
+    return true;
+}
+
+void PurchaseHistoryStore::index(const QString& username, const IndexEntry& entry,
+                                 const Transaction* trans) {
+    QVector<IndexEntry>& entries = m_index[username];
+    if (!entries.isEmpty() && entry.time < entries.last().time) {
+        auto pos = std::upper_bound(entries.begin(), entries.end(), entry,
+                                    [](const IndexEntry& a, const IndexEntry& b) { return a.time < b.time; });
+        entries.insert(pos, entry);
+        // Clock went backwards: drop the cached copy rather than reorder it
+        if (trans) m_cache.remove(username);
+        return;
+    }
+    entries.append(entry);
+
+    if (!trans) return;
+    if (QVector<Transaction>* cached = m_cache.take(username)) {
+        cached->append(*trans);
+        QVector<Transaction> rows = *cached;
+        delete cached;
+        cache(username, rows);
+    }
+}
+
+bool PurchaseHistoryStore::flush() {
+    QMutexLocker locker(&m_mutex);
+    return !m_file.isOpen() || m_file.flush();
+}
+
+void PurchaseHistoryStore::setCacheCapacity(int transactions) {
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(qMax(0, transactions));
+}
+
+int PurchaseHistoryStore::cacheCapacity() const {
+    QMutexLocker locker(&m_mutex);
+    return m_cache.maxCost();
+}
+
+int PurchaseHistoryStore::cachedHistories() const {
+    QMutexLocker locker(&m_mutex);
+    return m_cache.count();
+}
+
+qint64 PurchaseHistoryStore::timeKey(const QDateTime& date) {
+    QDate d = date.date();
+    QTime t = date.time();
+    return ((qint64(d.year()) * 100 + d.month()) * 100 + d.day()) * 1000000
+           + (t.hour() * 100 + t.minute()) * 100 + t.second();
+}
+
+qint64 PurchaseHistoryStore::timeKey(QByteArrayView text) {
+    // "yyyy-MM-dd hh:mm:ss" -> yyyyMMddhhmmss without building a QDateTime
+    qint64 key = 0;
+    int digits = 0;
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            key = key * 10 + (c - '0');
+            ++digits;
+        }
+    }
+    if (digits == 14) return key;
+    return timeKey(QDateTime::fromString(QString::fromUtf8(text), kDateFormat));
+}
+
+int PurchaseHistoryStore::rolesFor(const QString& username, const Transaction& trans) {
+    return (trans.buyerUsername == username ? AsBuyer : 0)
+           | (trans.sellerUsername == username ? AsSeller : 0);
+}
+
+QDateTime PurchaseHistoryStore::fromTimeKey(qint64 key) {
+    qint64 day = key / 1000000;
+    int seconds = int(key % 1000000);
+    return QDateTime(QDate(int(day / 10000), int(day / 100 % 100), int(day % 100)),
+                     QTime(seconds / 10000, seconds / 100 % 100, seconds % 100));
+}
+
+bool PurchaseHistoryStore::parseRow(QByteArrayView line, Transaction& trans,
+                                    QString* username, qint64* time) const {
+    FieldReader fields(line, ',', FieldReader::CsvQuotes);
+    if (fields.count() < 8) return false;
+
+    QByteArrayView user = fields.next();
+    if (username) *username = DataManager::unescapeCSV(QString::fromUtf8(user));
+
+    trans.productId = fields.nextInt();
+    trans.productName = DataManager::unescapeCSV(fields.nextString());
+    trans.sellerUsername = DataManager::unescapeCSV(fields.nextString());
+    trans.buyerUsername = DataManager::unescapeCSV(fields.nextString());
+    trans.quantity = fields.nextInt();
+    trans.totalPrice = fields.nextMoney();
+
+    qint64 key = timeKey(fields.next());
+    trans.date = fromTimeKey(key);
+    if (time) *time = key;
+    return true;
+}
+
+void PurchaseHistoryStore::cache(const QString& username, const QVector<Transaction>& rows) {
+    // Cost is the row count; a history larger than the whole cache is not kept
+    m_cache.insert(username, new QVector<Transaction>(rows), qMax(1, int(rows.size())));
+}
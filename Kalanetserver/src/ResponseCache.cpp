@@ -0,0 +1,61 @@
+#include "ResponseCache.h"
+#include "DataManager.h"
+
+ResponseCache::ResponseCache(DataManager* dm, QObject* parent)
+    : QObject(parent), m_dataManager(dm), m_version(0), m_maxEntries(256),
+      m_hits(0), m_misses(0) {
+    m_version = m_dataManager->getCatalogVersion();
+    connect(m_dataManager, &DataManager::dataChanged, this, &ResponseCache::invalidate);
+}
+
+void ResponseCache::syncVersion(quint64 current) {
+    // Caller holds m_mutex
+    if (current != m_version) {
+        m_entries.clear();
+        m_version = current;
+    }
+}
+
+bool ResponseCache::lookup(const QString& key, QByteArray& response) {
+    quint64 current = m_dataManager->getCatalogVersion();
+    QMutexLocker locker(&m_mutex);
+    syncVersion(current);
+
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd()) {
+        ++m_misses;
+        return false;
+    }
+    ++m_hits;
+    response = it.value(); // implicitly shared, no copy of the payload
+    return true;
+}
+
+void ResponseCache::insert(const QString& key, const QByteArray& response, quint64 version) {
+    if (m_maxEntries <= 0) return;
+
+    quint64 current = m_dataManager->getCatalogVersion();
+    QMutexLocker locker(&m_mutex);
+    syncVersion(current);
+
+    // The catalog changed while the response was being built
+    if (version != m_version) return;
+
+    if (!m_entries.contains(key) && m_entries.size() >= m_maxEntries) {
+        m_entries.erase(m_entries.begin());
+    }
+    m_entries.insert(key, response);
+}
+
+void ResponseCache::setMaxEntries(int maxEntries) {
+    QMutexLocker locker(&m_mutex);
+    m_maxEntries = maxEntries;
+    while (m_entries.size() > qMax(0, m_maxEntries)) {
+        m_entries.erase(m_entries.begin());
+    }
+}
+
+void ResponseCache::invalidate() {
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
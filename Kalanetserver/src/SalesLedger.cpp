@@ -0,0 +1,42 @@
+#include "SalesLedger.h"
+
+void SalesLedger::record(const Transaction& trans) {
+    QMutexLocker locker(&m_mutex);
+    SalesSummary& summary = m_sellers[trans.sellerUsername];
+    summary.revenue += trans.totalPrice;
+    summary.units += trans.quantity;
+    summary.orders++;
+
+    ProductSales& product = summary.byProduct[trans.productId];
+    product.productId = trans.productId;
+    product.productName = trans.productName;
+    product.units += trans.quantity;
+    product.revenue += trans.totalPrice;
+
+    QDate day = trans.date.date();
+    DaySales& daily = summary.byDay[day];
+    daily.day = day;
+    daily.orders++;
+    daily.units += trans.quantity;
+    daily.revenue += trans.totalPrice;
+}
+
+void SalesLedger::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_sellers.clear();
+}
+
+SalesSummary SalesLedger::summary(const QString& seller) const {
+    QMutexLocker locker(&m_mutex);
+    return m_sellers.value(seller);
+}
+
+bool SalesLedger::hasSales(const QString& seller) const {
+    QMutexLocker locker(&m_mutex);
+    return m_sellers.contains(seller);
+}
+
+int SalesLedger::sellerCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_sellers.size();
+}
@@ -1,40 +1,368 @@
 #include "Server.h"
+#include "TextFormat.h"
+#include "ImageStore.h"
 #include <QDebug>
+#include <QTimer>
+#include <QtMath>
 
-Server::Server(QObject* parent) : QTcpServer(parent) {
+Server::Server(QObject* parent)
+    : QTcpServer(parent), m_acceptTokens(0), m_rejected(0) {
     m_dataManager = DataManager::getInstance();
+    m_responseCache = new ResponseCache(m_dataManager, this);
+    m_idleWheel = new IdleTimerWheel(this);
+    connect(m_idleWheel, &IdleTimerWheel::expired, this, &Server::onIdleExpired);
+    setLimits(ServerLimits());
 }
 
 bool Server::start(quint16 port) {
-    return listen(QHostAddress::Any, port);
+    return start(QHostAddress::Any, port);
+}
+
+bool Server::start(const QHostAddress& address, quint16 port) {
+    return listen(address, port);
+}
+
+void Server::setLimits(const ServerLimits& limits) {
+    m_limits = limits;
+    m_idleWheel->setTimeout(m_limits.idleTimeoutSecs);
+    m_acceptTokens = m_limits.acceptBurst;
+    m_acceptClock.start();
 }
 
 void Server::incomingConnection(qintptr socketDescriptor) {
     QTcpSocket* socket = new QTcpSocket(this);
-    socket->setSocketDescriptor(socketDescriptor);
-    ClientHandler* handler = new ClientHandler(socket, m_dataManager, this);
-    m_clients.append(handler);
-    connect(socket, &QTcpSocket::disconnected, [this, handler]() {
-        m_clients.removeOne(handler);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        return;
+    }
+
+    throttleAccepts();
+
+    QString ip = socket->peerAddress().toString();
+    if (m_limits.maxConnections > 0 && m_registry.size() >= m_limits.maxConnections) {
+        rejectConnection(socket, "Server is at connection capacity");
+        return;
+    }
+    if (m_limits.maxConnectionsPerIp > 0 &&
+        m_registry.countForAddress(ip) >= m_limits.maxConnectionsPerIp) {
+        rejectConnection(socket, "Too many connections from your address");
+        return;
+    }
+
+    ClientHandler* handler = new ClientHandler(socket, m_dataManager, m_responseCache, this);
+    handler->setConnectionId(m_registry.insert(handler, ip));
+    m_idleWheel->add(handler);
+
+    connect(handler, &ClientHandler::authenticated, this, [this, handler](const QString& username) {
+        m_registry.bindUser(handler, username);
+    });
+    connect(socket, &QTcpSocket::readyRead, this, [this, handler]() {
+        m_idleWheel->touch(handler);
+    });
+    connect(socket, &QTcpSocket::disconnected, this, [this, handler]() {
+        m_registry.remove(handler);
+        m_idleWheel->remove(handler);
         handler->deleteLater();
     });
 }
 
+QList<ClientHandler*> Server::connectionsForUser(const QString& username) const {
+    return m_registry.byUser(username);
+}
+
+QList<ConnectionStats> Server::connectionStats() const {
+    QList<ConnectionStats> result;
+    for (ClientHandler* handler : m_registry.all())
+        result.append(handler->stats());
+    return result;
+}
+
+bool Server::kickConnection(quint64 id, const QString& reason) {
+    ClientHandler* handler = m_registry.byId(id);
+    if (!handler) return false;
+    handler->closeConnection(reason);
+    return true;
+}
+
+int Server::notifyUser(const QString& username, const QString& message) {
+    QList<ClientHandler*> handlers = m_registry.byUser(username);
+    QByteArray encoded = QString("NOTIFY %1\n").arg(message).toUtf8();
+    for (ClientHandler* handler : handlers)
+        handler->push(encoded);
+    return handlers.size();
+}
+
+void Server::rejectConnection(QTcpSocket* socket, const QString& reason) {
+    ++m_rejected;
+    connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+    socket->write(QString("ERROR %1\n").arg(reason).toUtf8());
+    socket->disconnectFromHost();
+    if (socket->state() == QAbstractSocket::UnconnectedState)
+        socket->deleteLater();
+}
+
+// Token bucket: when the burst is used up, stop accepting and let the
+// backlog drain at acceptsPerSecond instead of taking every SYN at once.
+void Server::throttleAccepts() {
+    if (m_limits.acceptsPerSecond <= 0) return;
+
+    double elapsed = m_acceptClock.restart() / 1000.0;
+    double capacity = qMax(1, m_limits.acceptBurst);
+    m_acceptTokens = qMin(capacity, m_acceptTokens + elapsed * m_limits.acceptsPerSecond);
+    m_acceptTokens -= 1.0;
+
+    if (m_acceptTokens < 1.0) {
+        pauseAccepting();
+        int waitMs = qCeil((1.0 - m_acceptTokens) * 1000.0 / m_limits.acceptsPerSecond);
+        QTimer::singleShot(waitMs, this, [this]() { resumeAccepting(); });
+    }
+}
+
+void Server::onIdleExpired(QObject* object) {
+    ClientHandler* handler = static_cast<ClientHandler*>(object);
+    qDebug() << "Closing idle connection";
+    handler->closeConnection("Idle timeout");
+}
+
 // ClientHandler implementation
-ClientHandler::ClientHandler(QTcpSocket* socket, DataManager* dm, QObject* parent)
-    : QObject(parent), m_socket(socket), m_dataManager(dm), m_currentUser(nullptr) {
+
+ClientHandler::ClientHandler(QTcpSocket* socket, DataManager* dm, ResponseCache* cache,
+                             QObject* parent)
+    : QObject(parent), m_socket(socket), m_dataManager(dm), m_responseCache(cache),
+      m_uploadExpected(0), m_currentUser(nullptr) {
+    m_stats.peerAddress = m_socket->peerAddress().toString();
+    m_stats.connectedAt = QDateTime::currentDateTime();
+    m_stats.lastActivity = m_stats.connectedAt;
     connect(m_socket, &QTcpSocket::readyRead, this, &ClientHandler::onReadyRead);
     connect(m_socket, &QTcpSocket::disconnected, this, &ClientHandler::onDisconnected);
 }
 
 void ClientHandler::onReadyRead() {
-    m_buffer += m_socket->readAll();
-    while (m_buffer.contains('\n')) {
-        int pos = m_buffer.indexOf('\n');
-        QString line = m_buffer.left(pos).trimmed();
-        m_buffer = m_buffer.mid(pos + 1);
+    QByteArray data = m_socket->readAll();
+    m_stats.bytesIn += data.size();
+    m_stats.lastActivity = QDateTime::currentDateTime();
+    m_buffer += data;
+
+    // Commands are lines, except the raw payload announced by PUT_IMAGE.
+    // The consumed prefix is dropped once per read.
+    qsizetype start = 0;
+    while (start < m_buffer.size()) {
+        if (m_uploadExpected > 0) {
+            if (m_buffer.size() - start < m_uploadExpected) break;
+            QByteArray payload = m_buffer.mid(start, m_uploadExpected);
+            start += m_uploadExpected;
+            m_uploadExpected = 0;
+            processUpload(payload);
+            continue;
+        }
+        qsizetype end = m_buffer.indexOf('\n', start);
+        if (end == -1) break;
+        QString line = QString::fromUtf8(m_buffer.constData() + start, end - start).trimmed();
+        start = end + 1;
         processCommand(line);
     }
+    m_buffer.remove(0, start);
+}
+
+void ClientHandler::processUpload(const QByteArray& data) {
+    QString hash = m_dataManager->getImageStore()->put(data);
+    if (hash.isEmpty()) {
+        sendError("Invalid image");
+        return;
+    }
+    sendResponse(QString("OK PUT_IMAGE %1\n").arg(hash));
+}
+
+template <typename Builder>
+void ClientHandler::sendCached(const QString& key, Builder build) {
+    // Read the version first so a concurrent change can't be cached as fresh
+    quint64 version = m_dataManager->getCatalogVersion();
+    QByteArray encoded = build();
+    m_responseCache->insert(key, encoded, version);
+    sendEncoded(encoded);
+}
+
+// "OK <type> <count> [<catalog tag>]" followed by one
+// id|name|category|price|stock|...|image row per product.
+// MY_PRODUCTS puts status before seller, the other lists after.
+static QByteArray encodeProductList(const char* type, const QVector<Product*>& products,
+                                    bool statusBeforeSeller, const QByteArray& tag = QByteArray()) {
+    QByteArray out;
+    out.reserve(32 + products.size() * 64);
+    RowWriter row(out, ' ');
+    row << "OK" << type << products.size();
+    if (!tag.isEmpty())
+        row << tag;
+    row.endRow();
+
+    RowWriter fields(out);
+    for (Product* p : products) {
+        fields << p->getProductId() << p->getName() << p->getCategory()
+               << p->getPrice() << p->getStock();
+        if (statusBeforeSeller)
+            fields << p->getStatusString() << p->getSellerUsername();
+        else
+            fields << p->getSellerUsername() << p->getStatusString();
+        fields << p->getImageHash();
+        fields.endRow();
+    }
+    return out;
+}
+
+// "OK <type> <amount>"
+static QByteArray encodeAmount(const char* type, Money amount) {
+    QByteArray out;
+    RowWriter row(out, ' ');
+    row << "OK" << type << amount;
+    row.endRow();
+    return out;
+}
+
+// "OK HISTORY <rows> <nextCursor>" followed by one row per transaction
+static QByteArray encodeHistoryPage(const PurchaseHistoryStore::Page& page) {
+    QByteArray out;
+    RowWriter header(out, ' ');
+    header << "OK" << "HISTORY" << int(page.rows.size()) << page.nextCursor;
+    header.endRow();
+
+    RowWriter fields(out);
+    for (const Transaction& t : page.rows) {
+        fields << t.productId << t.productName << t.sellerUsername << t.buyerUsername
+               << t.quantity << t.totalPrice << t.date.toString("yyyy-MM-dd hh:mm:ss");
+        fields.endRow();
+    }
+    return out;
+}
+
+// Reads the key=value options of GET_HISTORY; false on anything malformed
+static bool parseHistoryQuery(const QStringList& parts, int first,
+                              PurchaseHistoryStore::Query& query) {
+    for (int i = first; i < parts.size(); ++i) {
+        const QString& part = parts[i];
+        int eq = part.indexOf('=');
+        if (eq <= 0) return false;
+        QString key = part.left(eq).toLower();
+        QString value = part.mid(eq + 1);
+        bool ok = true;
+
+        if (key == "role") {
+            if (value == "buyer") query.roles = PurchaseHistoryStore::AsBuyer;
+            else if (value == "seller") query.roles = PurchaseHistoryStore::AsSeller;
+            else if (value == "all") query.roles = PurchaseHistoryStore::AnyRole;
+            else return false;
+        } else if (key == "from" || key == "to") {
+            // A bare date covers the whole day
+            QDateTime date = QDateTime::fromString(value, Qt::ISODate);
+            if (value.size() == 10) {
+                QDate day = QDate::fromString(value, Qt::ISODate);
+                date = QDateTime(day, key == "from" ? QTime(0, 0) : QTime(23, 59, 59));
+            }
+            if (!date.isValid()) return false;
+            (key == "from" ? query.from : query.to) = date;
+        } else if (key == "cursor") {
+            query.cursor = value.toInt(&ok);
+            ok = ok && query.cursor >= 0;
+        } else if (key == "limit") {
+            query.limit = qBound(1, value.toInt(&ok), 500);
+        } else {
+            return false;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// "OK SALES_SUMMARY <rows> <revenue> <units> <orders>" followed by
+// P|productId|name|units|revenue and D|date|orders|units|revenue rows
+static QByteArray encodeSalesSummary(const SalesSummary& summary) {
+    QByteArray out;
+    RowWriter header(out, ' ');
+    header << "OK" << "SALES_SUMMARY" << int(summary.byProduct.size() + summary.byDay.size())
+           << summary.revenue << summary.units << summary.orders;
+    header.endRow();
+
+    RowWriter fields(out);
+    for (const ProductSales& p : summary.byProduct) {
+        fields << "P" << p.productId << p.productName << p.units << p.revenue;
+        fields.endRow();
+    }
+    for (const DaySales& d : summary.byDay) {
+        fields << "D" << d.day.toString(Qt::ISODate) << d.orders << d.units << d.revenue;
+        fields.endRow();
+    }
+    return out;
+}
+
+// "OK <type> <rows>" followed by one productId|name|price|quantity row per
+// item and a final TOTAL|amount row, which is counted in <rows>
+static QByteArray encodeCart(const char* type, const Cart& cart, DataManager* dm) {
+    QByteArray items;
+    RowWriter fields(items);
+    int rows = 1;
+    Money total;
+    for (const CartItem& item : cart) {
+        Product* p = dm->getProduct(item.productId);
+        if (!p) continue;
+        fields << item.productId << p->getName() << p->getPrice() << item.quantity;
+        fields.endRow();
+        total += p->getPrice() * item.quantity;
+        ++rows;
+    }
+    fields << "TOTAL" << total;
+    fields.endRow();
+
+    QByteArray out;
+    RowWriter header(out, ' ');
+    header << "OK" << type << rows;
+    header.endRow();
+    return out + items;
+}
+
+// One CART_BATCH operation: add:<id>:<qty>, set:<id>:<qty> or remove:<id>
+struct CartOp {
+    enum Kind { Add, Set, Remove } kind;
+    int productId;
+    int quantity;
+};
+
+static bool parseCartOp(const QString& text, CartOp& op) {
+    QStringList fields = text.split(':');
+    bool ok = fields.size() >= 2;
+    op.productId = ok ? fields[1].toInt(&ok) : 0;
+    if (!ok) return false;
+
+    if (fields[0] == "remove" && fields.size() == 2) {
+        op.kind = CartOp::Remove;
+        op.quantity = 0;
+        return true;
+    }
+    if (fields.size() != 3) return false;
+    op.quantity = fields[2].toInt(&ok);
+    if (!ok) return false;
+    if (fields[0] == "add" && op.quantity > 0) {
+        op.kind = CartOp::Add;
+        return true;
+    }
+    if (fields[0] == "set" && op.quantity >= 0) {
+        op.kind = CartOp::Set;
+        return true;
+    }
+    return false;
+}
+
+// Largest number of operations in one CART_BATCH
+static const int kMaxCartBatch = 256;
+
+// Largest PUT_IMAGE payload accepted
+static const qint64 kMaxUploadBytes = 4 * 1024 * 1024;
+
+// Cache key of a read-only command, or an empty string if it isn't cacheable
+static QString cacheKeyFor(const QString& command, const QStringList& parts) {
+    if (command == "GET_APPROVED_PRODUCTS" || command == "GET_PENDING_PRODUCTS")
+        return command;
+    if (command == "GET_MY_PRODUCTS" && parts.size() >= 2)
+        return command + " " + parts[1];
+    return QString();
 }
 
 void ClientHandler::processCommand(const QString& cmd) {
@@ -42,18 +370,90 @@ void ClientHandler::processCommand(const QString& cmd) {
     if (parts.isEmpty()) return;
 
     QString command = parts[0].toUpper();
+    m_stats.commands++;
+
+    // A client whose cached catalog is current gets no rows at all
+    if (command == "GET_APPROVED_PRODUCTS" && parts.size() >= 2) {
+        QByteArray tag = m_dataManager->getCatalogTag();
+        if (parts[1].toUtf8() == tag) {
+            sendEncoded("OK APPROVED_PRODUCTS_NOT_MODIFIED " + tag + "\n");
+            return;
+        }
+    }
+
+    // Cache hits touch no User/Product objects, so they skip the command lock.
+    // A seller's list may outlive the seller, so that check comes first.
+    QString cacheKey = cacheKeyFor(command, parts);
+    if (command == "GET_MY_PRODUCTS" && !cacheKey.isEmpty()
+        && !m_dataManager->userExists(parts[1])) {
+        sendError("User not found");
+        return;
+    }
+    if (!cacheKey.isEmpty()) {
+        QByteArray cached;
+        if (m_responseCache->lookup(cacheKey, cached)) {
+            sendEncoded(cached);
+            return;
+        }
+    }
+
+    // Images touch no User/Product objects either
+    if (command == "GET_IMAGE" && parts.size() >= 3) {
+        // GET_IMAGE <hash> <thumb|medium|full> [<etag>]
+        ImageStore::Size size;
+        if (!ImageStore::parseSize(parts[2], size)) {
+            sendError("Invalid image size");
+            return;
+        }
+        ImageStore::Image image = m_dataManager->getImageStore()->image(parts[1], size);
+        if (image.isNull()) {
+            sendError("Image not found");
+            return;
+        }
+        QByteArray out;
+        RowWriter header(out, ' ');
+        if (parts.size() >= 4 && parts[3] == image.etag) {
+            header << "OK" << "IMAGE_NOT_MODIFIED" << parts[1] << parts[2] << image.etag;
+            header.endRow();
+        } else {
+            // Header line, then exactly <length> raw bytes
+            header << "OK" << "IMAGE" << parts[1] << parts[2] << image.etag
+                   << qint64(image.data.size());
+            header.endRow();
+            out += image.data;
+        }
+        sendEncoded(out);
+        return;
+    }
+    if (command == "PUT_IMAGE" && parts.size() >= 2) {
+        // PUT_IMAGE <length>, then <length> raw bytes
+        bool ok = false;
+        qint64 length = parts[1].toLongLong(&ok);
+        if (!ok || length <= 0 || length > kMaxUploadBytes) {
+            // The payload can't be told apart from commands; give up on the stream
+            closeConnection("Invalid image length");
+            return;
+        }
+        m_uploadExpected = length;
+        return;
+    }
+
+    // Commands from handlers in different worker threads run one at a time
+    QMutexLocker locker(m_dataManager->getCommandMutex());
 
     if (command == "LOGIN" && parts.size() >= 3) {
         QString username = parts[1];
         QString password = parts[2];
         if (m_dataManager->validateLogin(username, password)) {
             m_currentUser = m_dataManager->getUser(username);
+            m_stats.username = username;
+            emit authenticated(username);
             QString userType = (m_currentUser->getUserType() == UserType::ADMIN) ? "Admin" : "Customer";
-            QString response = QString("OK LOGIN %1|%2|%3\n")
-                    .arg(username)
-                    .arg(m_currentUser->getWalletBalance())
-                    .arg(userType);
-            sendResponse(response);
+            QByteArray response = "OK LOGIN ";
+            RowWriter fields(response);
+            fields << username << m_currentUser->getWalletBalance() << userType;
+            fields.endRow();
+            sendEncoded(response);
         } else {
             sendError("Invalid username or password");
         }
@@ -73,68 +473,55 @@ void ClientHandler::processCommand(const QString& cmd) {
         }
 
         QString hashed = User::hashPassword(password);
-        User* user = nullptr;
-        if (type == UserType::ADMIN)
-            user = new Admin(username, hashed, email, phone, address);
-        else
-            user = new Customer(username, hashed, email, phone, address);
+        User* user = m_dataManager->createUser(type, username, hashed, email, phone, address);
 
         if (m_dataManager->addUser(user)) {
             sendResponse("OK SIGNUP\n");
         } else {
             sendError("Failed to create account");
-            delete user;
+            m_dataManager->releaseUser(user);
         }
     }
     else if (command == "GET_APPROVED_PRODUCTS") {
-        QVector<Product*> products = m_dataManager->getApprovedProducts();
-        QString response = "OK APPROVED_PRODUCTS\n";
-        for (Product* p : products) {
-            response += QString("%1|%2|%3|%4|%5|%6|%7\n")
-                    .arg(p->getProductId())
-                    .arg(p->getName())
-                    .arg(p->getCategory())
-                    .arg(p->getPrice())
-                    .arg(p->getStock())
-                    .arg(p->getSellerUsername())
-                    .arg(p->getStatusString());
-        }
-        sendResponse(response);
+        // GET_APPROVED_PRODUCTS [<catalog tag>]; the tag is read before the
+        // products so it can only be older than the rows it labels
+        sendCached(cacheKey, [this]() {
+            QByteArray tag = m_dataManager->getCatalogTag();
+            return encodeProductList("APPROVED_PRODUCTS", m_dataManager->getApprovedProducts(), false, tag);
+        });
     }
     else if (command == "GET_PENDING_PRODUCTS") {
-        QVector<Product*> products = m_dataManager->getPendingProducts();
-        QString response = "OK PENDING_PRODUCTS\n";
-        for (Product* p : products) {
-            response += QString("%1|%2|%3|%4|%5|%6|%7\n")
-                    .arg(p->getProductId())
-                    .arg(p->getName())
-                    .arg(p->getCategory())
-                    .arg(p->getPrice())
-                    .arg(p->getStock())
-                    .arg(p->getSellerUsername())
-                    .arg(p->getStatusString());
-        }
-        sendResponse(response);
+        sendCached(cacheKey, [this]() {
+            return encodeProductList("PENDING_PRODUCTS", m_dataManager->getPendingProducts(), false);
+        });
     }
     else if (command == "ADD_PRODUCT" && parts.size() >= 2) {
-        // Format: ADD_PRODUCT name|desc|category|price|stock|seller
+        // Format: ADD_PRODUCT name|desc|category|price|stock|seller[|imageHash]
         QString data = parts[1];
         QStringList fields = data.split('|');
         if (fields.size() >= 6) {
             QString name = fields[0];
             QString desc = fields[1];
             QString category = fields[2];
-            double price = fields[3].toDouble();
+            Money price = Money::fromString(fields[3]);
             int stock = fields[4].toInt();
             QString seller = fields[5];
 
             int id = m_dataManager->getNextProductId();
-            Product* p = new Product(id, name, desc, category, price, stock, seller);
+            Product* p = m_dataManager->createProduct(id, name, desc, category, price, stock, seller);
+            if (fields.size() >= 7 && !fields[6].isEmpty()) {
+                if (!m_dataManager->getImageStore()->contains(fields[6])) {
+                    sendError("Unknown image");
+                    m_dataManager->releaseProduct(p);
+                    return;
+                }
+                p->setImageHash(fields[6]);
+            }
             if (m_dataManager->addProduct(p)) {
                 sendResponse("OK ADD_PRODUCT\n");
             } else {
                 sendError("Failed to add product");
-                delete p;
+                m_dataManager->releaseProduct(p);
             }
         } else {
             sendError("Invalid product data");
@@ -162,7 +549,6 @@ void ClientHandler::processCommand(const QString& cmd) {
         Customer* cust = dynamic_cast<Customer*>(user);
         if (cust) {
             cust->addToCart(productId, quantity);
-            m_dataManager->saveUsers();
             sendResponse("OK ADD_TO_CART\n");
         } else {
             sendError("User not found or not a customer");
@@ -173,33 +559,60 @@ void ClientHandler::processCommand(const QString& cmd) {
         User* user = m_dataManager->getUser(username);
         Customer* cust = dynamic_cast<Customer*>(user);
         if (cust) {
-            const QMap<int, int>& cart = cust->getCart();
-            double total = 0;
-            QString response = "OK CART\n";
-            for (auto it = cart.begin(); it != cart.end(); ++it) {
-                Product* p = m_dataManager->getProduct(it.key());
-                if (p) {
-                    response += QString("%1|%2|%3|%4\n")
-                            .arg(it.key())
-                            .arg(p->getName())
-                            .arg(p->getPrice())
-                            .arg(it.value());
-                    total += p->getPrice() * it.value();
-                }
-            }
-            response += QString("TOTAL|%1\n").arg(total);
-            sendResponse(response);
+            sendEncoded(encodeCart("CART", cust->getCart(), m_dataManager));
         } else {
             sendError("User not found or not a customer");
         }
     }
+    else if (command == "CART_BATCH" && parts.size() >= 3) {
+        // CART_BATCH <username> <op> [<op> ...]; all or nothing, one write
+        QString username = parts[1];
+        Customer* cust = dynamic_cast<Customer*>(m_dataManager->getUser(username));
+        if (!cust) {
+            sendError("User not found or not a customer");
+            return;
+        }
+        if (parts.size() - 2 > kMaxCartBatch) {
+            sendError("Too many cart operations");
+            return;
+        }
+
+        // Applied to a copy, so a failing operation leaves the cart as it was
+        Cart cart = cust->getCart();
+        for (int i = 2; i < parts.size(); ++i) {
+            CartOp op;
+            if (!parseCartOp(parts[i], op)) {
+                sendError("Invalid cart operation: " + parts[i]);
+                return;
+            }
+            if (op.kind == CartOp::Remove || (op.kind == CartOp::Set && op.quantity == 0)) {
+                cart.remove(op.productId);
+                continue;
+            }
+            Product* p = m_dataManager->getProduct(op.productId);
+            if (!p || !p->isApproved()) {
+                sendError(QString("Product %1 is not available").arg(op.productId));
+                return;
+            }
+            // Checked against the room left, so repeated large adds cannot overflow
+            int current = op.kind == CartOp::Add ? cart.quantity(op.productId) : 0;
+            if (op.quantity > p->getStock() - current) {
+                sendError(QString("Only %1 of product %2 in stock").arg(p->getStock()).arg(op.productId));
+                return;
+            }
+            cart.set(op.productId, current + op.quantity);
+        }
+
+        // Persisted as one append to carts.csv holding only the changed items
+        cust->setCart(cart);
+        sendEncoded(encodeCart("CART_BATCH", cart, m_dataManager));
+    }
     else if (command == "REMOVE_FROM_CART" && parts.size() >= 3) {
         QString username = parts[1];
         int productId = parts[2].toInt();
         Customer* cust = dynamic_cast<Customer*>(m_dataManager->getUser(username));
         if (cust) {
             cust->removeFromCart(productId);
-            m_dataManager->saveUsers();
             sendResponse("OK REMOVE_FROM_CART\n");
         } else {
             sendError("User not found or not a customer");
@@ -210,7 +623,6 @@ void ClientHandler::processCommand(const QString& cmd) {
         Customer* cust = dynamic_cast<Customer*>(m_dataManager->getUser(username));
         if (cust) {
             cust->clearCart();
-            m_dataManager->saveUsers();
             sendResponse("OK CLEAR_CART\n");
         } else {
             sendError("User not found or not a customer");
@@ -228,11 +640,11 @@ void ClientHandler::processCommand(const QString& cmd) {
             return;
         }
 
-        double total = 0;
-        QMap<int, int> cart = cust->getCart();
-        for (auto it = cart.begin(); it != cart.end(); ++it) {
-            Product* p = m_dataManager->getProduct(it.key());
-            if (p) total += p->getPrice() * it.value();
+        Money total;
+        const Cart& cart = cust->getCart();
+        for (const CartItem& item : cart) {
+            Product* p = m_dataManager->getProduct(item.productId);
+            if (p) total += p->getPrice() * item.quantity;
         }
 
         if (cust->getWalletBalance() < total) {
@@ -241,16 +653,17 @@ void ClientHandler::processCommand(const QString& cmd) {
         }
 
         // Process each item
-        for (auto it = cart.begin(); it != cart.end(); ++it) {
-            Product* p = m_dataManager->getProduct(it.key());
+        for (const CartItem& item : cart) {
+            Product* p = m_dataManager->getProduct(item.productId);
             if (!p) continue;
-            int qty = it.value();
-            double itemTotal = p->getPrice() * qty;
+            int qty = item.quantity;
+            Money itemTotal = p->getPrice() * qty;
 
             cust->deductFunds(itemTotal);
             User* seller = m_dataManager->getUser(p->getSellerUsername());
             if (seller) seller->addFunds(itemTotal);
             p->purchase(qty);
+            m_dataManager->updateProduct(p);
 
             Transaction trans;
             trans.productId = p->getProductId();
@@ -260,15 +673,14 @@ void ClientHandler::processCommand(const QString& cmd) {
             trans.quantity = qty;
             trans.totalPrice = itemTotal;
             trans.date = QDateTime::currentDateTime();
+            // Also indexed as the seller's sale; no separate copy is kept
             cust->addTransaction(trans);
-            if (Customer* sellerCust = dynamic_cast<Customer*>(seller))
-                sellerCust->addTransaction(trans);
         }
 
         cust->clearCart();
-        m_dataManager->saveAllData();
+        m_dataManager->saveChanges();
 
-        sendResponse(QString("OK CHECKOUT %1\n").arg(total));
+        sendEncoded(encodeAmount("CHECKOUT", total));
     }
     else if (command == "GET_MY_PRODUCTS" && parts.size() >= 2) {
         QString username = parts[1];
@@ -277,41 +689,54 @@ void ClientHandler::processCommand(const QString& cmd) {
             sendError("User not found");
             return;
         }
-        QVector<Product*> myProducts;
-        for (Product* p : m_dataManager->getAllProducts()) {
-            if (p->getSellerUsername() == username)
-                myProducts.append(p);
+        sendCached(cacheKey, [this, &username]() {
+            return encodeProductList("MY_PRODUCTS",
+                                     m_dataManager->getProductsBySeller(username), true);
+        });
+    }
+    else if (command == "GET_HISTORY" && parts.size() >= 2) {
+        // GET_HISTORY <username> [role=buyer|seller|all] [from=<date>] [to=<date>]
+        //             [cursor=<n>] [limit=<n>]
+        QString username = parts[1];
+        if (!dynamic_cast<Customer*>(m_dataManager->getUser(username))) {
+            sendError("User not found or not a customer");
+            return;
         }
-        QString response = "OK MY_PRODUCTS\n";
-        for (Product* p : myProducts) {
-            response += QString("%1|%2|%3|%4|%5|%6|%7\n")
-                    .arg(p->getProductId())
-                    .arg(p->getName())
-                    .arg(p->getCategory())
-                    .arg(p->getPrice())
-                    .arg(p->getStock())
-                    .arg(p->getStatusString())
-                    .arg(p->getSellerUsername());
+        PurchaseHistoryStore::Query query;
+        if (!parseHistoryQuery(parts, 2, query)) {
+            sendError("Invalid history query");
+            return;
         }
-        sendResponse(response);
+        sendEncoded(encodeHistoryPage(m_dataManager->getHistoryStore()->page(username, query)));
+    }
+    else if (command == "GET_SALES_SUMMARY" && parts.size() >= 2) {
+        QString username = parts[1];
+        if (!m_dataManager->getUser(username)) {
+            sendError("User not found");
+            return;
+        }
+        sendEncoded(encodeSalesSummary(m_dataManager->getSalesLedger().summary(username)));
     }
     else if (command == "GET_WALLET" && parts.size() >= 2) {
         QString username = parts[1];
         User* user = m_dataManager->getUser(username);
         if (user) {
-            sendResponse(QString("OK WALLET %1\n").arg(user->getWalletBalance()));
+            sendEncoded(encodeAmount("WALLET", user->getWalletBalance()));
         } else {
             sendError("User not found");
         }
     }
     else if (command == "DEPOSIT" && parts.size() >= 3) {
         QString username = parts[1];
-        double amount = parts[2].toDouble();
+        bool ok = false;
+        Money amount = Money::fromString(parts[2], &ok);
         User* user = m_dataManager->getUser(username);
-        if (user) {
+        if (!ok || amount <= Money()) {
+            sendError("Invalid amount");
+        } else if (user) {
             user->addFunds(amount);
             m_dataManager->saveUsers();
-            sendResponse(QString("OK DEPOSIT %1\n").arg(user->getWalletBalance()));
+            sendEncoded(encodeAmount("DEPOSIT", user->getWalletBalance()));
         } else {
             sendError("User not found");
         }
@@ -322,13 +747,27 @@ void ClientHandler::processCommand(const QString& cmd) {
 }
 
 void ClientHandler::sendResponse(const QString& response) {
-    m_socket->write(response.toUtf8());
+    sendEncoded(response.toUtf8());
+}
+
+void ClientHandler::sendEncoded(const QByteArray& response) {
+    m_stats.bytesOut += response.size();
+    m_socket->write(response);
+}
+
+void ClientHandler::push(const QByteArray& message) {
+    sendEncoded(message);
 }
 
 void ClientHandler::sendError(const QString& msg) {
     sendResponse("ERROR " + msg + "\n");
 }
 
+void ClientHandler::closeConnection(const QString& reason) {
+    sendError(reason);
+    m_socket->disconnectFromHost();
+}
+
 void ClientHandler::onDisconnected() {
     m_socket->deleteLater();
 }
\ No newline at end of file
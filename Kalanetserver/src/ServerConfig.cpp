@@ -0,0 +1,150 @@
+#include "ServerConfig.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QSettings>
+#include <QFileInfo>
+#include <climits>
+
+namespace {
+
+bool parseDurability(const QString& text, DurabilityMode& mode) {
+    QString value = text.trimmed().toLower();
+    if (value == "immediate" || value == "sync") {
+        mode = DurabilityMode::Immediate;
+        return true;
+    }
+    if (value == "deferred" || value == "async") {
+        mode = DurabilityMode::Deferred;
+        return true;
+    }
+    return false;
+}
+
+bool parseInt(const QString& text, int minValue, int maxValue, int& out) {
+    bool ok = false;
+    int value = text.trimmed().toInt(&ok);
+    if (!ok || value < minValue || value > maxValue) return false;
+    out = value;
+    return true;
+}
+
+} // namespace
+
+bool ServerConfig::load(const QCoreApplication& app, ServerConfig& config, QString& error) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("KalaNet shopping server");
+    parser.addHelpOption();
+
+    QCommandLineOption configOpt({"c", "config"}, "Read options from INI <file>.", "file");
+    QCommandLineOption portOpt({"p", "port"}, "Listen on <port> (0 = ephemeral).", "port");
+    QCommandLineOption bindOpt({"b", "bind"}, "Bind to <address>.", "address");
+    QCommandLineOption dataOpt({"d", "data-dir"}, "Store CSV files in <dir>.", "dir");
+    QCommandLineOption workersOpt("workers", "Number of worker threads.", "n");
+    QCommandLineOption durabilityOpt("durability", "immediate or deferred.", "mode");
+    QCommandLineOption flushOpt("flush-interval", "Deferred flush interval in ms.", "ms");
+    QCommandLineOption cacheOpt("cache-entries", "Response cache capacity.", "n");
+    QCommandLineOption historyOpt("history-cache", "Purchase-history rows kept in memory.", "n");
+    QCommandLineOption logOpt("log-level", "debug, info, warning or critical.", "level");
+    QCommandLineOption maxConnOpt("max-connections", "Global connection cap (0 = off).", "n");
+    QCommandLineOption maxIpOpt("max-per-ip", "Per-address connection cap (0 = off).", "n");
+    QCommandLineOption idleOpt("idle-timeout", "Idle timeout in seconds (0 = off).", "s");
+    QCommandLineOption acceptRateOpt("accept-rate", "Accepted connections per second (0 = off).", "n");
+    parser.addOptions({configOpt, portOpt, bindOpt, dataOpt, workersOpt, durabilityOpt,
+                       flushOpt, cacheOpt, historyOpt, logOpt, maxConnOpt, maxIpOpt,
+                       idleOpt, acceptRateOpt});
+    parser.process(app);
+
+    // Option name -> raw value, file first so flags win
+    QMap<QString, QString> values;
+    if (parser.isSet(configOpt)) {
+        QString path = parser.value(configOpt);
+        if (!QFileInfo::exists(path)) {
+            error = "Config file not found: " + path;
+            return false;
+        }
+        QSettings settings(path, QSettings::IniFormat);
+        settings.beginGroup("server");
+        for (const QString& key : settings.childKeys())
+            values[key] = settings.value(key).toString();
+        settings.endGroup();
+    }
+    const QList<QCommandLineOption> flagOptions = {portOpt, bindOpt, dataOpt, workersOpt,
+                                                   durabilityOpt, flushOpt, cacheOpt, historyOpt, logOpt,
+                                                   maxConnOpt, maxIpOpt, idleOpt, acceptRateOpt};
+    for (const QCommandLineOption& opt : flagOptions) {
+        QString name = opt.names().last();
+        if (parser.isSet(opt)) values[name] = parser.value(opt);
+    }
+
+    int intValue = 0;
+    if (values.contains("port")) {
+        if (!parseInt(values["port"], 0, 65535, intValue)) {
+            error = "Invalid port: " + values["port"];
+            return false;
+        }
+        config.port = static_cast<quint16>(intValue);
+    }
+    if (values.contains("bind")) {
+        QString text = values["bind"].trimmed();
+        if (text == "any" || text == "*") config.bindAddress = QHostAddress::Any;
+        else if (text == "localhost") config.bindAddress = QHostAddress::LocalHost;
+        else if (!config.bindAddress.setAddress(text)) {
+            error = "Invalid bind address: " + text;
+            return false;
+        }
+    }
+    if (values.contains("data-dir")) config.dataDir = values["data-dir"];
+    if (values.contains("workers")) {
+        if (!parseInt(values["workers"], 1, 256, config.workerThreads)) {
+            error = "Invalid worker count: " + values["workers"];
+            return false;
+        }
+    }
+    if (values.contains("durability") && !parseDurability(values["durability"], config.durability)) {
+        error = "Invalid durability mode: " + values["durability"];
+        return false;
+    }
+
+    struct IntSetting { const char* key; int minValue; int* target; };
+    const IntSetting intSettings[] = {
+        {"flush-interval", 0, &config.flushIntervalMs},
+        {"cache-entries", 0, &config.responseCacheEntries},
+        {"history-cache", 0, &config.historyCacheRows},
+        {"max-connections", 0, &config.limits.maxConnections},
+        {"max-per-ip", 0, &config.limits.maxConnectionsPerIp},
+        {"idle-timeout", 0, &config.limits.idleTimeoutSecs},
+        {"accept-rate", 0, &config.limits.acceptsPerSecond},
+    };
+    for (const IntSetting& setting : intSettings) {
+        QString key = setting.key;
+        if (values.contains(key) && !parseInt(values[key], setting.minValue, INT_MAX, *setting.target)) {
+            error = QString("Invalid value for %1: %2").arg(key, values[key]);
+            return false;
+        }
+    }
+    if (values.contains("accept-rate"))
+        config.limits.acceptBurst = qMax(1, config.limits.acceptsPerSecond * 2);
+
+    if (values.contains("log-level")) {
+        QString level = values["log-level"].trimmed().toLower();
+        if (level != "debug" && level != "info" && level != "warning" && level != "critical") {
+            error = "Invalid log level: " + level;
+            return false;
+        }
+        config.logLevel = level;
+    }
+    return true;
+}
+
+void ServerConfig::applyLogLevel() const {
+    QString rules;
+    if (logLevel == "info") {
+        rules = "*.debug=false";
+    } else if (logLevel == "warning") {
+        rules = "*.debug=false\n*.info=false";
+    } else if (logLevel == "critical") {
+        rules = "*.debug=false\n*.info=false\n*.warning=false";
+    }
+    QLoggingCategory::setFilterRules(rules);
+}
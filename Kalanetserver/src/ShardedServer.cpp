@@ -0,0 +1,176 @@
+#include "ShardedServer.h"
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+ShardedServer::ShardedServer(int shards, QObject* parent)
+    : QObject(parent), m_port(0) {
+    shards = qMax(1, shards);
+    for (int i = 0; i < shards; ++i) {
+        QThread* thread = new QThread(this);
+        thread->setObjectName(QString("kalanet-worker-%1").arg(i));
+
+        // Created here, then handed to the worker; children follow it
+        Server* server = new Server();
+        server->moveToThread(thread);
+        connect(thread, &QThread::finished, server, &QObject::deleteLater);
+        thread->start();
+
+        m_threads.append(thread);
+        m_servers.append(server);
+    }
+}
+
+ShardedServer::~ShardedServer() {
+    stop();
+}
+
+bool ShardedServer::isSupported() {
+#if defined(Q_OS_UNIX) && defined(SO_REUSEPORT)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ShardedServer::setLimits(const ServerLimits& limits) {
+    int shards = m_servers.size();
+    auto share = [shards](int value) {
+        return value <= 0 ? 0 : qMax(1, (value + shards - 1) / shards);
+    };
+    ServerLimits perShard = limits;
+    perShard.maxConnections = share(limits.maxConnections);
+    perShard.maxConnectionsPerIp = share(limits.maxConnectionsPerIp);
+    perShard.acceptsPerSecond = share(limits.acceptsPerSecond);
+    perShard.acceptBurst = share(limits.acceptBurst);
+
+    for (Server* server : m_servers) {
+        QMetaObject::invokeMethod(server, [server, perShard]() {
+            server->setLimits(perShard);
+        }, Qt::BlockingQueuedConnection);
+    }
+}
+
+void ShardedServer::setResponseCacheEntries(int entries) {
+    for (Server* server : m_servers)
+        server->responseCache()->setMaxEntries(entries);
+}
+
+bool ShardedServer::start(const QHostAddress& address, quint16 port) {
+    if (!isSupported()) {
+        m_error = "SO_REUSEPORT is not available on this platform";
+        return false;
+    }
+
+    for (Server* server : m_servers) {
+        // Port 0: the first bind picks the port, the rest join it
+        qintptr fd = openListeningSocket(address, port);
+        if (fd < 0) {
+            stop();
+            return false;
+        }
+        // QTcpServer must adopt the socket in the thread that will accept on it
+        quint16 boundPort = 0;
+        QString error;
+        QMetaObject::invokeMethod(server, [server, fd, &boundPort, &error]() {
+            if (server->setSocketDescriptor(fd))
+                boundPort = server->serverPort();
+            else
+                error = server->errorString();
+        }, Qt::BlockingQueuedConnection);
+        if (boundPort == 0) {
+            m_error = error;
+#ifdef Q_OS_UNIX
+            ::close(static_cast<int>(fd));
+#endif
+            stop();
+            return false;
+        }
+        port = boundPort;
+    }
+
+    m_port = port;
+    qDebug() << "Started" << m_servers.size() << "accept shards on port" << m_port;
+    return true;
+}
+
+void ShardedServer::stop() {
+    for (QThread* thread : m_threads) {
+        thread->quit();
+        thread->wait();
+    }
+    m_servers.clear();
+}
+
+int ShardedServer::connectionCount() const {
+    int total = 0;
+    for (Server* server : m_servers) {
+        int count = 0;
+        QMetaObject::invokeMethod(server, [server]() {
+            return server->connectionCount();
+        }, Qt::BlockingQueuedConnection, &count);
+        total += count;
+    }
+    return total;
+}
+
+qintptr ShardedServer::openListeningSocket(const QHostAddress& address, quint16 port) {
+#if defined(Q_OS_UNIX) && defined(SO_REUSEPORT)
+    bool ipv4 = address.protocol() == QAbstractSocket::IPv4Protocol;
+    int fd = ::socket(ipv4 ? AF_INET : AF_INET6, SOCK_STREAM, 0);
+    if (fd < 0) {
+        m_error = QString("socket: %1").arg(strerror(errno));
+        return -1;
+    }
+
+    int one = 1;
+    int zero = 0;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) {
+        m_error = QString("SO_REUSEPORT: %1").arg(strerror(errno));
+        ::close(fd);
+        return -1;
+    }
+
+    int rc;
+    if (ipv4) {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(address.toIPv4Address());
+        rc = ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    } else {
+        // QHostAddress::Any is dual-stack, like QTcpServer::listen
+        if (address == QHostAddress::Any)
+            ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+        sockaddr_in6 addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin6_family = AF_INET6;
+        addr.sin6_port = htons(port);
+        Q_IPV6ADDR ip6 = address == QHostAddress::Any ? QHostAddress(QHostAddress::AnyIPv6).toIPv6Address()
+                                                       : address.toIPv6Address();
+        memcpy(&addr.sin6_addr, &ip6, sizeof(addr.sin6_addr));
+        rc = ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+    if (rc < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        m_error = QString("bind/listen on port %1: %2").arg(port).arg(strerror(errno));
+        ::close(fd);
+        return -1;
+    }
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(port);
+    m_error = "SO_REUSEPORT is not available on this platform";
+    return -1;
+#endif
+}
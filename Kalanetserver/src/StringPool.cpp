@@ -0,0 +1,38 @@
+#include "StringPool.h"
+
+StringPool::StringPool() {
+}
+
+int StringPool::intern(const QString& str) {
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_ids.constFind(str);
+        if (it != m_ids.constEnd()) return it.value();
+    }
+
+    QWriteLocker locker(&m_lock);
+    // Another thread may have added it between the two locks
+    auto it = m_ids.constFind(str);
+    if (it != m_ids.constEnd()) return it.value();
+
+    int id = m_strings.size();
+    m_strings.append(str);
+    m_ids.insert(str, id);
+    return id;
+}
+
+int StringPool::find(const QString& str) const {
+    QReadLocker locker(&m_lock);
+    return m_ids.value(str, -1);
+}
+
+QString StringPool::string(int id) const {
+    QReadLocker locker(&m_lock);
+    if (id < 0 || id >= m_strings.size()) return QString();
+    return m_strings[id];
+}
+
+int StringPool::size() const {
+    QReadLocker locker(&m_lock);
+    return m_strings.size();
+}
@@ -1,6 +1,9 @@
 #include "User.h"
+#include "PurchaseHistoryStore.h"
+#include "CartStore.h"
 #include <QCryptographicHash>
 #include <QRegularExpression>
+#include <limits>
 
 // Transaction implementation
 void Transaction::saveToStream(QDataStream& stream) const {
@@ -15,17 +18,17 @@ void Transaction::loadFromStream(QDataStream& stream) {
 
 // User base class implementation
 User::User() 
-    : walletBalance(0.0), userType(UserType::CUSTOMER) {
+    : walletBalance(), userType(UserType::CUSTOMER) {
 }
 
 User::User(const QString& user, const QString& pass, const QString& mail, 
            const QString& ph, const QString& addr, UserType type)
     : username(user), hashedPassword(pass), email(mail), 
-      phone(ph), address(addr), walletBalance(0.0), userType(type) {
+      phone(ph), address(addr), walletBalance(), userType(type) {
 }
 
-bool User::deductFunds(double amount) {
-    if (amount <= 0 || amount > walletBalance) {
+bool User::deductFunds(Money amount) {
+    if (amount <= Money() || amount > walletBalance) {
         return false;
     }
     walletBalance -= amount;
@@ -82,6 +85,9 @@ void Admin::loadFromStream(QDataStream& stream) {
 }
 
 // Customer implementation
+PurchaseHistoryStore* Customer::historyStore = nullptr;
+CartStore* Customer::cartStore = nullptr;
+
 Customer::Customer() : User() {
     userType = UserType::CUSTOMER;
 }
@@ -92,19 +98,47 @@ Customer::Customer(const QString& user, const QString& pass, const QString& mail
 }
 
 void Customer::addToCart(int productId, int quantity) {
-    if (cart.contains(productId)) {
-        cart[productId] += quantity;
-    } else {
-        cart[productId] = quantity;
-    }
+    qint64 total = qint64(cart.quantity(productId)) + quantity;
+    setCartQuantity(productId, int(qBound<qint64>(0, total, std::numeric_limits<int>::max())));
+}
+
+void Customer::setCartQuantity(int productId, int quantity) {
+    quantity = qMax(0, quantity);
+    if (cart.quantity(productId) == quantity) return;
+    cart.set(productId, quantity);
+    if (cartStore)
+        cartStore->append(username, {CartItem{productId, quantity}});
 }
 
 void Customer::removeFromCart(int productId) {
-    cart.remove(productId);
+    setCartQuantity(productId, 0);
+}
+
+void Customer::clearCart() {
+    if (cart.isEmpty()) return;
+    cart.clear();
+    if (cartStore)
+        cartStore->appendClear(username);
+}
+
+void Customer::setCart(const Cart& newCart) {
+    QVector<CartItem> changes = Cart::diff(cart, newCart);
+    cart = newCart;
+    if (cartStore)
+        cartStore->append(username, changes);
 }
 
 void Customer::addTransaction(const Transaction& trans) {
-    purchaseHistory.append(trans);
+    if (historyStore)
+        historyStore->append(username, trans);
+    else
+        purchaseHistory.append(trans);
+}
+
+QVector<Transaction> Customer::getPurchaseHistory() const {
+    if (historyStore)
+        return historyStore->history(username);
+    return purchaseHistory;
 }
 
 void Customer::addRegisteredProduct(int productId) {
@@ -118,13 +152,14 @@ void Customer::saveToStream(QDataStream& stream) const {
 
     // Save cart
     stream << cart.size();
-    for (auto it = cart.begin(); it != cart.end(); ++it) {
-        stream << it.key() << it.value();
+    for (const CartItem& item : cart) {
+        stream << item.productId << item.quantity;
     }
 
     // Save purchase history
-    stream << purchaseHistory.size();
-    for (const auto& trans : purchaseHistory) {
+    const QVector<Transaction> history = getPurchaseHistory();
+    stream << history.size();
+    for (const auto& trans : history) {
         trans.saveToStream(stream);
     }
 
@@ -145,7 +180,7 @@ void Customer::loadFromStream(QDataStream& stream) {
     for (int i = 0; i < cartSize; ++i) {
         int key, value;
         stream >> key >> value;
-        cart[key] = value;
+        cart.set(key, value);
     }
 
     // Load purchase history
@@ -155,7 +190,9 @@ void Customer::loadFromStream(QDataStream& stream) {
     for (int i = 0; i < historySize; ++i) {
         Transaction trans;
         trans.loadFromStream(stream);
-        purchaseHistory.append(trans);
+        // A store already holds the history on disk
+        if (!historyStore)
+            purchaseHistory.append(trans);
     }
 
     // Load registered products
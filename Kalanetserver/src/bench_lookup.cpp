@@ -0,0 +1,93 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QRandomGenerator>
+#include <QVector>
+#include "FlatHashMap.h"
+#include "ProductCatalog.h"
+#include "DataManager.h"
+
+// Lookup throughput benchmark: QMap versus the structures DataManager uses
+// now (FlatHashMap for users, ProductCatalog for products).
+// Usage: bench_lookup [count]   (default 1000000)
+
+static void report(const char* label, int lookups, qint64 nsecs, quintptr checksum) {
+    double perSec = nsecs > 0 ? lookups * 1e9 / nsecs : 0;
+    qDebug().noquote() << QString("%1 %2 Mlookups/s  (%3 ns/lookup, checksum %4)")
+                              .arg(label, -28)
+                              .arg(perSec / 1e6, 0, 'f', 2)
+                              .arg(double(nsecs) / lookups, 0, 'f', 1)
+                              .arg(checksum);
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const int count = argc > 1 ? QString(argv[1]).toInt() : 1000000;
+    const int lookups = count;
+    QRandomGenerator rng(42);
+
+    qDebug() << "=== KalaNet Lookup Benchmark ===" << count << "users /" << count << "products";
+
+    // Users: username -> User*. Values are never dereferenced.
+    QVector<QString> names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i)
+        names.append(QString("user%1").arg(i));
+
+    QVector<int> order(lookups);
+    for (int i = 0; i < lookups; ++i)
+        order[i] = rng.bounded(count);
+
+    QMap<QString, User*> userMap;
+    FlatHashMap<QString, User*> userHash;
+    userHash.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        User* fake = reinterpret_cast<User*>(quintptr(i + 1));
+        userMap.insert(names[i], fake);
+        userHash.insert(names[i], fake);
+    }
+
+    QElapsedTimer timer;
+    quintptr checksum = 0;
+    timer.start();
+    for (int i : order)
+        checksum += reinterpret_cast<quintptr>(userMap.value(names[i], nullptr));
+    report("users QMap<QString>", lookups, timer.nsecsElapsed(), checksum);
+
+    checksum = 0;
+    timer.start();
+    for (int i : order)
+        checksum += reinterpret_cast<quintptr>(userHash.value(names[i], nullptr));
+    report("users FlatHashMap<QString>", lookups, timer.nsecsElapsed(), checksum);
+
+    // Products: id -> Product*
+    QMap<int, Product*> productMap;
+    ProductCatalog catalog;
+    QVector<Product*> owned;
+    owned.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Product* p = new Product(i + 1, QString(), QString(), "Electronics",
+                                 Money::fromUnits(1 + i % 1000), i % 50, names[i % 1000]);
+        owned.append(p);
+        productMap.insert(i + 1, p);
+        catalog.upsert(p);
+    }
+
+    checksum = 0;
+    timer.start();
+    for (int i : order)
+        checksum += reinterpret_cast<quintptr>(productMap.value(i + 1, nullptr));
+    report("products QMap<int>", lookups, timer.nsecsElapsed(), checksum);
+
+    checksum = 0;
+    timer.start();
+    for (int i : order)
+        checksum += reinterpret_cast<quintptr>(catalog.product(i + 1));
+    report("products ProductCatalog", lookups, timer.nsecsElapsed(), checksum);
+
+    qDeleteAll(owned);
+    qDebug() << "=== Benchmark Complete ===";
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include "TextFormat.h"
+
+// Formatting/parsing benchmark: product rows written with chained
+// QString::arg() and parsed with split()/toInt()/toDouble(), versus
+// RowWriter/FieldReader over UTF-8 bytes.
+// Usage: bench_textformat [rows]   (default 1000000)
+
+struct Row {
+    int id;
+    QString name;
+    QString category;
+    Money price;
+    int stock;
+    QString seller;
+};
+
+static void report(const char* label, int rows, qint64 nsecs, qint64 checksum) {
+    double perSec = nsecs > 0 ? rows * 1e9 / nsecs : 0;
+    qDebug().noquote() << QString("%1 %2 Mrows/s  (%3 ns/row, checksum %4)")
+                              .arg(label, -28)
+                              .arg(perSec / 1e6, 0, 'f', 2)
+                              .arg(double(nsecs) / rows, 0, 'f', 1)
+                              .arg(checksum);
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const int count = argc > 1 ? QString(argv[1]).toInt() : 1000000;
+    qDebug() << "=== KalaNet Text Format Benchmark ===" << count << "rows";
+
+    QVector<Row> rows;
+    rows.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        rows.append({i + 1, QString("Product %1").arg(i), "Electronics",
+                     Money::fromCents(100 + (i * 37) % 100000), i % 50,
+                     QString("seller%1").arg(i % 1000)});
+    }
+
+    QElapsedTimer timer;
+
+    // Format: QString::arg, then UTF-8 encode as ClientHandler used to
+    timer.start();
+    QString text;
+    for (const Row& r : rows) {
+        text += QString("%1|%2|%3|%4|%5|%6|%7\n")
+                    .arg(r.id)
+                    .arg(r.name)
+                    .arg(r.category)
+                    .arg(r.price.toString())
+                    .arg(r.stock)
+                    .arg(r.seller)
+                    .arg("Approved");
+    }
+    QByteArray argBytes = text.toUtf8();
+    report("format QString::arg", count, timer.nsecsElapsed(), argBytes.size());
+
+    // Format: RowWriter
+    timer.start();
+    QByteArray writerBytes;
+    writerBytes.reserve(count * 64);
+    RowWriter writer(writerBytes);
+    for (const Row& r : rows) {
+        writer << r.id << r.name << r.category << r.price << r.stock << r.seller << "Approved";
+        writer.endRow();
+    }
+    report("format RowWriter", count, timer.nsecsElapsed(), writerBytes.size());
+
+    if (argBytes != writerBytes)
+        qDebug() << "WARNING: outputs differ";
+
+    // Parse: decode, split, toInt/fromString as NetworkManager used to
+    qint64 checksum = 0;
+    timer.start();
+    const QStringList lines = QString::fromUtf8(argBytes).split('\n', Qt::SkipEmptyParts);
+    for (const QString& line : lines) {
+        QStringList fields = line.split('|');
+        checksum += fields[0].toInt() + Money::fromString(fields[3]).cents() + fields[4].toInt();
+    }
+    report("parse split/toInt", count, timer.nsecsElapsed(), checksum);
+
+    // Parse: LineReader/FieldReader
+    checksum = 0;
+    timer.start();
+    LineReader lineReader(writerBytes);
+    QByteArrayView line;
+    while (lineReader.next(line)) {
+        FieldReader fields(line);
+        int id = fields.nextInt();
+        fields.next();
+        fields.next();
+        Money price = fields.nextMoney();
+        checksum += id + price.cents() + fields.nextInt();
+    }
+    report("parse FieldReader", count, timer.nsecsElapsed(), checksum);
+
+    qDebug() << "=== Benchmark Complete ===";
+    return 0;
+}
@@ -1,14 +1,105 @@
 #include <QCoreApplication>
 #include "Server.h"
+#include "ServerConfig.h"
+#include "ShardedServer.h"
 #include <QDebug>
+#ifdef Q_OS_UNIX
+#include <QSocketNotifier>
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_UNIX
+namespace {
+int quitPipe[2] = {-1, -1};
+
+void onQuitSignal(int) {
+    char byte = 1;
+    ssize_t written = ::write(quitPipe[0], &byte, 1);
+    Q_UNUSED(written);
+}
+
+// SIGINT/SIGTERM make exec() return so deferred writes reach disk in
+// destroyInstance(); the handler only writes to a socket pair and the
+// quit happens on the event loop
+void installQuitHandler(QCoreApplication& app) {
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, quitPipe) != 0) {
+        qWarning() << "Failed to create signal socket pair, signals will not flush data";
+        return;
+    }
+    auto* notifier = new QSocketNotifier(quitPipe[1], QSocketNotifier::Read, &app);
+    QObject::connect(notifier, &QSocketNotifier::activated, &app, [notifier]() {
+        notifier->setEnabled(false);
+        char byte;
+        ssize_t got = ::read(quitPipe[1], &byte, 1);
+        Q_UNUSED(got);
+        qInfo() << "Shutting down";
+        QCoreApplication::quit();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = onQuitSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+}
+#endif
 
 int main(int argc, char *argv[]) {
     QCoreApplication app(argc, argv);
+    app.setApplicationName("KalaNetServer");
+
+    ServerConfig config;
+    QString error;
+    if (!ServerConfig::load(app, config, error)) {
+        qCritical().noquote() << error;
+        return 1;
+    }
+    config.applyLogLevel();
+#ifdef Q_OS_UNIX
+    installQuitHandler(app);
+#endif
+
+    DataManager::setDataDirectory(config.dataDir);
+    DataManager* dm = DataManager::getInstance();
+    dm->setDurabilityMode(config.durability, config.flushIntervalMs);
+    dm->setHistoryCacheCapacity(config.historyCacheRows);
+
+    if (config.workerThreads > 1 && ShardedServer::isSupported()) {
+        ShardedServer sharded(config.workerThreads);
+        sharded.setLimits(config.limits);
+        sharded.setResponseCacheEntries(config.responseCacheEntries);
+        if (!sharded.start(config.bindAddress, config.port)) {
+            qCritical().noquote() << "Failed to start server:" << sharded.errorString();
+            return 1;
+        }
+        qInfo().noquote() << "KalaNet Server started on port" << sharded.serverPort()
+                          << "with" << sharded.shardCount() << "workers, data dir"
+                          << dm->getDataDirectory();
+
+        int result = app.exec();
+        sharded.stop();
+        DataManager::destroyInstance();
+        return result;
+    }
+    if (config.workerThreads > 1)
+        qWarning() << "SO_REUSEPORT is not available, running single-threaded";
+
     Server server;
-    if (!server.start(12345)) {
-        qDebug() << "Failed to start server on port 12345";
+    server.setLimits(config.limits);
+    server.responseCache()->setMaxEntries(config.responseCacheEntries);
+    if (!server.start(config.bindAddress, config.port)) {
+        qCritical() << "Failed to start server on port" << config.port << ":" << server.errorString();
         return 1;
     }
-    qDebug() << "KalaNet Server started on port 12345";
-    return app.exec();
-}
\ No newline at end of file
+    qInfo().noquote() << "KalaNet Server started on"
+                      << server.serverAddress().toString() + ":" + QString::number(server.serverPort())
+                      << "data dir" << dm->getDataDirectory();
+
+    int result = app.exec();
+    DataManager::destroyInstance();
+    return result;
+}
@@ -0,0 +1,176 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <QVector>
+#include <sys/resource.h>
+#include "Server.h"
+
+// Soak test: open many local connections against a Server with a small
+// connection cap and check that it rejects the excess, that idle sockets are
+// closed by the timer wheel and that memory stays bounded.
+
+static long residentKb() {
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+    while (!status.atEnd()) {
+        QByteArray line = status.readLine();
+        if (line.startsWith("VmRSS:"))
+            return line.mid(6).trimmed().split(' ').first().toLong();
+    }
+    return -1;
+}
+
+// Runs the event loop until 'done' holds or 'timeoutMs' passes
+template <typename Predicate>
+static bool waitFor(QCoreApplication& app, Predicate done, int timeoutMs) {
+    QElapsedTimer wait;
+    wait.start();
+    while (!done() && wait.elapsed() < timeoutMs) {
+        app.processEvents(QEventLoop::AllEvents, 50);
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+    }
+    return done();
+}
+
+static QVector<QTcpSocket*> openSockets(int count, quint16 port) {
+    QVector<QTcpSocket*> sockets;
+    for (int i = 0; i < count; ++i) {
+        QTcpSocket* socket = new QTcpSocket();
+        socket->connectToHost(QHostAddress::LocalHost, port);
+        sockets.append(socket);
+    }
+    return sockets;
+}
+
+static void closeSockets(QVector<QTcpSocket*>& sockets) {
+    for (QTcpSocket* socket : sockets) {
+        socket->abort();
+        delete socket;
+    }
+    sockets.clear();
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    const int totalConnections = 10000;
+    const int maxConnections = 200;
+    const int batchSize = 300; // every batch overshoots the cap
+    const int idleBatch = 50;
+    const int idleTimeoutSecs = 2;
+
+    // Client and server ends both live in this process
+    rlimit fdLimit;
+    if (getrlimit(RLIMIT_NOFILE, &fdLimit) == 0) {
+        fdLimit.rlim_cur = fdLimit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &fdLimit);
+    }
+
+    // Keep the test away from the real ./data
+    QTemporaryDir dataDir;
+    if (!dataDir.isValid()) {
+        qDebug() << "Failed to create a temporary data directory";
+        return 1;
+    }
+    DataManager::setDataDirectory(dataDir.path());
+
+    qDebug() << "=== KalaNet Connection Soak Test ===";
+
+    Server server;
+    ServerLimits limits;
+    limits.maxConnections = maxConnections;
+    limits.maxConnectionsPerIp = 0; // everything comes from 127.0.0.1
+    limits.idleTimeoutSecs = 0;     // churn first; idle reaping is checked below
+    limits.acceptsPerSecond = 0;
+    server.setLimits(limits);
+
+    if (!server.listen(QHostAddress::LocalHost, 0)) {
+        qDebug() << "Failed to listen:" << server.errorString();
+        return 1;
+    }
+    quint16 port = server.serverPort();
+
+    bool ok = true;
+    long baselineKb = residentKb();
+    int maxSeen = 0;
+    QElapsedTimer clock;
+    clock.start();
+
+    // Churn: each batch fills the cap and the rest must be turned away
+    for (int opened = 0; opened < totalConnections && ok; opened += batchSize) {
+        quint64 rejectedBefore = server.rejectedCount();
+        QVector<QTcpSocket*> batch = openSockets(batchSize, port);
+
+        bool settled = waitFor(app, [&]() {
+            return server.connectionCount() + int(server.rejectedCount() - rejectedBefore) >= batchSize;
+        }, 5000);
+        maxSeen = qMax(maxSeen, server.connectionCount());
+        int rejected = int(server.rejectedCount() - rejectedBefore);
+
+        if (!settled || server.connectionCount() != maxConnections
+            || rejected != batchSize - maxConnections) {
+            qDebug() << "FAIL: batch at" << opened << "accepted" << server.connectionCount()
+                     << "rejected" << rejected << "of" << batchSize;
+            ok = false;
+        }
+
+        // Drop the batch and let the server unregister it before the next one
+        closeSockets(batch);
+        if (!waitFor(app, [&]() { return server.connectionCount() == 0; }, 10000)) {
+            qDebug() << "FAIL: connections leaked:" << server.connectionCount();
+            ok = false;
+        }
+    }
+    qDebug() << "Opened" << totalConnections << "connections in" << clock.elapsed() << "ms";
+    qDebug() << "Peak concurrent:" << maxSeen << "rejected:" << server.rejectedCount();
+
+    if (maxSeen > maxConnections) {
+        qDebug() << "FAIL: connection cap exceeded";
+        ok = false;
+    }
+
+    // Idle: connections that never send anything are closed by the wheel
+    limits.idleTimeoutSecs = idleTimeoutSecs;
+    server.setLimits(limits);
+    QVector<QTcpSocket*> idle = openSockets(idleBatch, port);
+    if (!waitFor(app, [&]() { return server.connectionCount() == idleBatch; }, 5000)) {
+        qDebug() << "FAIL: only" << server.connectionCount() << "of" << idleBatch << "idle sockets accepted";
+        ok = false;
+    }
+    QElapsedTimer idleClock;
+    idleClock.start();
+    bool reaped = waitFor(app, [&]() {
+        if (server.connectionCount() != 0) return false;
+        for (QTcpSocket* socket : idle) {
+            if (socket->state() != QAbstractSocket::UnconnectedState) return false;
+        }
+        return true;
+    }, (idleTimeoutSecs + 5) * 1000);
+    if (!reaped) {
+        qDebug() << "FAIL: idle connections still open:" << server.connectionCount();
+        ok = false;
+    } else if (idleClock.elapsed() < (idleTimeoutSecs - 1) * 1000) {
+        qDebug() << "FAIL: idle connections closed early, after" << idleClock.elapsed() << "ms";
+        ok = false;
+    } else {
+        qDebug() << "Idle connections closed after" << idleClock.elapsed() << "ms";
+    }
+    closeSockets(idle);
+
+    long finalKb = residentKb();
+    qDebug() << "RSS baseline:" << baselineKb << "KB, final:" << finalKb << "KB";
+
+    // Generous bound: growth must not scale with the number of connections opened
+    if (baselineKb > 0 && finalKb - baselineKb > 64 * 1024) {
+        qDebug() << "FAIL: resident memory grew by" << (finalKb - baselineKb) << "KB";
+        ok = false;
+    }
+
+    qDebug() << (ok ? "=== Soak Test PASSED ===" : "=== Soak Test FAILED ===");
+    DataManager::destroyInstance();
+    return ok ? 0 : 1;
+}
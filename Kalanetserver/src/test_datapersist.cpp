@@ -26,7 +26,7 @@ int main(int argc, char *argv[]) {
             "1234567890",
             "Test Address"
         );
-        testUser->addFunds(1000);
+        testUser->addFunds(Money::fromUnits(1000));
 
         if (dm->addUser(testUser)) {
             qDebug() << "Test user created successfully!";
@@ -38,7 +38,7 @@ int main(int argc, char *argv[]) {
         qDebug() << "Test user already exists";
         User* user = dm->getUser("testuser");
         if (user) {
-            qDebug() << "Test user wallet:" << user->getWalletBalance();
+            qDebug() << "Test user wallet:" << user->getWalletBalance().toString();
         }
     }
 
@@ -50,7 +50,7 @@ int main(int argc, char *argv[]) {
             "Test Product",
             "This is a test product",
             "Electronics",
-            99.99,
+            Money::fromCents(9999),
             10,
             "admin"
         );